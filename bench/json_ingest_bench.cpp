@@ -0,0 +1,109 @@
+// /controller JSON解析ベンチマーク（ホスト実行用）
+// 従来方式（String本文コピー + ヒープJsonDocument + String組み立て）と
+// 固定領域方式（parseControllerJson）の解析時間とヒープ確保回数を比較する
+//
+// ビルド・実行: cd bench && make run
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "controller_json.h"
+
+// ---- ヒープ確保回数の計測（glibcのmallocをラップ）----
+static size_t alloc_count = 0;
+static bool counting = false;
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void *__libc_calloc(size_t n, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+extern "C" void *malloc(size_t size) {
+    if (counting) alloc_count++;
+    return __libc_malloc(size);
+}
+extern "C" void *realloc(void *ptr, size_t size) {
+    if (counting) alloc_count++;
+    return __libc_realloc(ptr, size);
+}
+extern "C" void *calloc(size_t n, size_t size) {
+    if (counting) alloc_count++;
+    return __libc_calloc(n, size);
+}
+extern "C" void free(void *ptr) {
+    __libc_free(ptr);
+}
+
+// ---- 計測対象のペイロード ----
+struct Payload {
+    const char *name;
+    const char *json;
+};
+
+static const Payload payloads[] = {
+    { "full",
+      "{\"buttons\":{\"A\":true,\"B\":false,\"X\":false,\"Y\":false},"
+      "\"lstick\":{\"x\":0,\"y\":0},\"rstick\":{\"x\":0,\"y\":0},"
+      "\"shoulder\":{\"L\":false,\"R\":false,\"ZL\":false,\"ZR\":false},"
+      "\"system\":{\"plus\":false,\"minus\":false,\"home\":false}}" },
+    { "buttons", "{\"buttons\":{\"A\":true,\"B\":false,\"X\":true,\"Y\":false}}" },
+    { "sticks", "{\"lstick\":{\"x\":-73,\"y\":100},\"rstick\":{\"x\":12,\"y\":-5}}" },
+    { "shoulder+system",
+      "{\"shoulder\":{\"L\":false,\"R\":true,\"ZL\":false,\"ZR\":true},"
+      "\"system\":{\"plus\":false,\"minus\":false,\"home\":false}}" },
+};
+
+static const int ITERATIONS = 200000;
+
+// 従来方式の再現（handleControllerPOST()の旧実装相当）
+static bool legacyIngest(const char *json, ControllerState &state) {
+    std::string body(json);                 // server.arg("plain") のコピー
+    JsonDocument doc;                       // ヒープ確保のJsonDocument
+    if (deserializeJson(doc, body)) return false;
+
+    applyControllerJson(doc.as<JsonVariantConst>(), state, 0);
+    std::string latestInput = inputName(state.last_input);  // 最新入力のString組み立て
+
+    std::string reply = "{\"status\":\"OK\"}";  // レスポンスのString
+    return !reply.empty();
+}
+
+static bool arenaIngest(const char *json, size_t length, ControllerState &state) {
+    return parseControllerJson(json, length, state, 0) == JSON_INGEST_OK;
+}
+
+template <typename F>
+static void measure(const char *method, const Payload &payload, F ingest) {
+    ControllerState state;
+    ingest(state);  // ウォームアップ
+
+    alloc_count = 0;
+    counting = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        if (!ingest(state)) {
+            counting = false;
+            printf("%-16s %-8s parse error\n", payload.name, method);
+            return;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    counting = false;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+    printf("%-16s %-8s %10.1f ns/req %8.2f allocs/req\n",
+           payload.name, method, ns, (double)alloc_count / ITERATIONS);
+}
+
+int main() {
+    printf("%-16s %-8s %17s %18s\n", "payload", "method", "parse time", "heap allocs");
+    for (const Payload &payload : payloads) {
+        size_t length = strlen(payload.json);
+        measure("legacy", payload, [&](ControllerState &state) { return legacyIngest(payload.json, state); });
+        measure("arena", payload, [&](ControllerState &state) { return arenaIngest(payload.json, length, state); });
+    }
+    printf("arena high water: %zu / %d bytes\n", jsonIngestHighWater(), JSON_INGEST_ARENA_SIZE);
+    return 0;
+}
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+入力→レポートのエンドツーエンド遅延・スループット計測（Linux、env:nativeのビルドを使用）
+
+負荷生成側で各入力の送信時刻を記録し、native版のHID記録（送信レポートの時刻）と突き合わせて
+遅延のパーセンタイル、維持できる最大入力レート、統合・欠落した入力数を求める。
+
+    pio run -e native
+    cd bench && python3 latency_bench.py
+    python3 latency_bench.py --transport udp --rates 100,500,1000,2000 --duration 5
+
+各入力は右スティック(x, y)の組み合わせで識別する（レポートの値から送信した入力を特定）。
+"""
+
+import argparse
+import http.client
+import json
+import os
+import signal
+import socket
+import struct
+import subprocess
+import tempfile
+import time
+
+DEFAULT_PROGRAM = os.path.join(os.path.dirname(__file__), "..", ".pio", "build", "native", "program")
+
+# src/switch_report.cpp の stickToReport() と同じ変換
+STICK_NEUTRAL = 128
+
+def stick_to_report(value):
+    value = max(-100, min(100, value))
+    if value < 0:
+        return STICK_NEUTRAL - (-value * STICK_NEUTRAL) // 100
+    return STICK_NEUTRAL + (value * (255 - STICK_NEUTRAL)) // 100
+
+REPORT_TO_STICK = {stick_to_report(v): v for v in range(-100, 101)}
+
+# 入力ID ⇔ 右スティック(x, y)（ニュートラルは使わない）
+ID_SPACE = 201 * 201
+
+def id_to_stick(input_id):
+    return input_id % 201 - 100, input_id // 201 - 100
+
+def stick_to_id(x, y):
+    return (y + 100) * 201 + (x + 100)
+
+NEUTRAL_ID = stick_to_id(0, 0)
+
+def input_ids(count):
+    """ニュートラルを除いた入力IDを順に返す"""
+    input_id = 0
+    for _ in range(count):
+        input_id += 1
+        if input_id == NEUTRAL_ID:
+            input_id += 1
+        yield input_id
+
+# UDPバイナリフレーム（src/input_frame.h と同じ）
+HEADER = struct.Struct("<HBBII")
+STATE = struct.Struct("<HBBhhhh")
+
+
+class HttpLoad:
+    """keep-aliveの1接続でPOST /controllerを順に送信"""
+
+    def __init__(self, port):
+        self.conn = http.client.HTTPConnection("127.0.0.1", port, timeout=2)
+
+    def send(self, input_id, seq):
+        x, y = id_to_stick(input_id)
+        body = json.dumps({"rstick": {"x": x, "y": y}})
+        try:
+            self.conn.request("POST", "/controller", body=body, headers={"Content-Type": "application/json"})
+            response = self.conn.getresponse()
+            response.read()
+            return response.status == 200
+        except (OSError, http.client.HTTPException):
+            self.conn.close()
+            return False
+
+
+class UdpLoad:
+    """バイナリフレームを1状態ずつ（再送分なし）送信"""
+
+    def __init__(self, port):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.addr = ("127.0.0.1", port)
+
+    def send(self, input_id, seq):
+        x, y = id_to_stick(input_id)
+        frame = HEADER.pack(0x5753, 1, 1, seq, 0) + STATE.pack(0, 8, 0, 0, 0, x, y)
+        try:
+            self.sock.sendto(frame, self.addr)
+            return True
+        except OSError:
+            return False
+
+
+def start_program(program, http_port, udp_port, hid_log):
+    proc = subprocess.Popen(
+        [program, "--http-port", str(http_port), "--udp-port", str(udp_port), "--hid-log", hid_log],
+        stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    # 待ち受け開始まで待つ
+    deadline = time.monotonic() + 5
+    while time.monotonic() < deadline:
+        try:
+            socket.create_connection(("127.0.0.1", http_port), timeout=0.1).close()
+            return proc
+        except OSError:
+            time.sleep(0.02)
+    proc.kill()
+    raise RuntimeError("native program did not start")
+
+
+def stop_program(proc):
+    proc.send_signal(signal.SIGTERM)
+    output, _ = proc.communicate(timeout=5)
+    # 終了時の統計行: "reports N  changes N  suppressed N  taps stretched N  ...  udp applied N"
+    stats = {}
+    for line in output.splitlines():
+        if line.startswith("reports "):
+            words = line.split()
+            stats = {"reports": int(words[1]), "changes": int(words[3]), "udp_applied": int(words[-1])}
+    return stats
+
+
+def read_reports(hid_log):
+    """入力IDごとに最初に送信されたレポートの時刻（ns）"""
+    first_seen = {}
+    with open(hid_log) as f:
+        next(f)
+        for line in f:
+            mono_us, _, _, _, _, _, rx, ry = (int(v) for v in line.split(","))
+            # レポートのYは反転済み
+            x, y = REPORT_TO_STICK[rx], -REPORT_TO_STICK[ry]
+            first_seen.setdefault(stick_to_id(x, y), mono_us * 1000)
+    return first_seen
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    index = min(len(values) - 1, int(round(p / 100 * (len(values) - 1))))
+    return values[index]
+
+
+def run_scenario(args, transport, rate):
+    hid_log = tempfile.NamedTemporaryFile(prefix="hid_", suffix=".csv", delete=False).name
+    proc = start_program(args.program, args.http_port, args.udp_port, hid_log)
+    load = HttpLoad(args.http_port) if transport == "http" else UdpLoad(args.udp_port)
+
+    # 送信レート: rate=0は応答を待って可能な限り速く（クローズドループ）
+    count = min(int(rate * args.duration) if rate > 0 else ID_SPACE - 1, ID_SPACE - 2)
+    interval_ns = int(1e9 / rate) if rate > 0 else 0
+    sent = []      # (入力ID, 送信時刻ns)
+    failed = 0
+
+    start = time.monotonic_ns()
+    end = start + int(args.duration * 1e9)
+    next_send = start
+    for seq, input_id in enumerate(input_ids(count), 1):
+        now = time.monotonic_ns()
+        if now >= end:
+            break
+        if interval_ns:
+            if next_send > now:
+                time.sleep((next_send - now) / 1e9)
+            next_send += interval_ns
+        send_time = time.monotonic_ns()
+        if load.send(input_id, seq):
+            sent.append((input_id, send_time))
+        else:
+            failed += 1
+    elapsed = (time.monotonic_ns() - start) / 1e9
+
+    # 最後の入力がレポートされるまで待ってから終了
+    time.sleep(0.05)
+    server_stats = stop_program(proc)
+    first_seen = read_reports(hid_log)
+    os.unlink(hid_log)
+
+    latencies = sorted((first_seen[i] - t) / 1e6 for i, t in sent if i in first_seen)
+    lost = failed
+    if transport == "udp" and server_stats:
+        lost += max(0, len(sent) - server_stats["udp_applied"])
+    merged = len(sent) - len(latencies) - (lost - failed)
+
+    return {
+        "transport": transport,
+        "target_rate": rate,
+        "sent": len(sent),
+        "achieved_rate": round(len(sent) / elapsed, 1) if elapsed > 0 else 0,
+        "reported": len(latencies),
+        "merged": max(0, merged),
+        "dropped": lost,
+        "p50_ms": round(percentile(latencies, 50), 3),
+        "p90_ms": round(percentile(latencies, 90), 3),
+        "p99_ms": round(percentile(latencies, 99), 3),
+        "max_ms": round(latencies[-1], 3) if latencies else 0.0,
+        "reports": server_stats.get("reports", 0),
+    }
+
+
+def print_table(results):
+    columns = ["transport", "target_rate", "achieved_rate", "sent", "reported", "merged", "dropped",
+               "p50_ms", "p90_ms", "p99_ms", "max_ms"]
+    print("  ".join(f"{c:>13}" for c in columns))
+    for r in results:
+        print("  ".join(f"{str(r[c]):>13}" for c in columns))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="入力→レポート遅延ベンチマーク（env:native）")
+    parser.add_argument("--program", default=DEFAULT_PROGRAM, help="native版の実行ファイル")
+    parser.add_argument("--transport", default="http,udp", help="http, udp（カンマ区切り）")
+    parser.add_argument("--rates", default="50,125,250,500,1000,0",
+                        help="入力レートHz（カンマ区切り、0=応答を待って最大速度）")
+    parser.add_argument("--duration", type=float, default=3.0, help="1シナリオの送信時間（秒）")
+    parser.add_argument("--http-port", type=int, default=18080)
+    parser.add_argument("--udp-port", type=int, default=14210)
+    parser.add_argument("--json", action="store_true", help="結果をJSONで出力")
+    args = parser.parse_args()
+
+    results = []
+    for transport in args.transport.split(","):
+        for rate in (int(r) for r in args.rates.split(",")):
+            results.append(run_scenario(args, transport, rate))
+
+    if args.json:
+        print(json.dumps(results, indent=2))
+        return
+
+    print_table(results)
+
+    # 維持できる最大レート: 目標の95%以上を送信でき、欠落なし
+    for transport in args.transport.split(","):
+        sustained = [r["achieved_rate"] for r in results
+                     if r["transport"] == transport and r["dropped"] == 0
+                     and (r["target_rate"] == 0 or r["achieved_rate"] >= r["target_rate"] * 0.95)]
+        print(f"{transport}: max sustained {max(sustained) if sustained else 0} updates/s")
+
+
+if __name__ == "__main__":
+    main()
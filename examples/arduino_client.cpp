@@ -2,11 +2,13 @@
  * Nintendo Switch Controller Web API - Arduino Client Sample
  * M5AtomS3 SwitchController WebサーバーにPOSTリクエストを送信するサンプル
  * ESP32系マイコン用（WiFi機能が必要）
+ *
+ * SwitchControllerClientは接続を維持して（keep-alive）送信し、変化したセクションのみ送る。
+ * 送信ごとの往復時間（RTT）を記録するため、自分の環境の遅延を確認できる。
  */
 
 #include <WiFi.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
+#include <stdarg.h>
 
 // WiFi設定
 const char* ssid = "YOUR_WIFI_SSID";          // WiFi SSID
@@ -14,10 +16,266 @@ const char* password = "YOUR_WIFI_PASSWORD";   // WiFi パスワード
 
 // M5AtomS3 コントローラーの設定
 const char* controllerIP = "192.168.1.100";    // M5AtomS3のIPアドレス
-String controllerURL = "http://" + String(controllerIP) + "/controller";
+const uint16_t controllerPort = 80;            // /controller（非同期HTTP）
+const uint16_t adminPort = 8080;               // /timeline 等（WEB_ADMIN_PORT）
 
-// HTTPクライアント
-HTTPClient http;
+#define CLIENT_TIMEOUT_MS 2000       // 応答待ちタイムアウト（ms）
+#define CLIENT_BATCH_MAX 32          // 1リクエストにまとめるフレーム数の上限（TIMELINE_MAX_FRAMES以下）
+#define CLIENT_BATCH_BUFFER 4096     // まとめて送るフレームのJSONバッファ
+
+// コントローラー入力（全セクション）
+struct ControllerInput {
+    bool a = false, b = false, x = false, y = false;
+    int lstickX = 0, lstickY = 0, rstickX = 0, rstickY = 0;
+    bool l = false, r = false, zl = false, zr = false;
+    bool plus = false, minus = false, home = false;
+};
+
+// 往復時間（リクエスト送信開始→レスポンス受信完了）の統計
+struct RttStats {
+    uint32_t count = 0;
+    uint32_t failures = 0;
+    uint32_t last_us = 0;
+    uint32_t min_us = 0;
+    uint32_t max_us = 0;
+    uint64_t total_us = 0;
+};
+
+/**
+ * コントローラーAPIクライアント
+ * 接続を維持したまま（keep-alive）送信し、前回から変化したセクションのみ送る
+ */
+class SwitchControllerClient {
+public:
+    SwitchControllerClient(const char* host, uint16_t port, uint16_t adminPort)
+        : host(host), port(port), adminPort(adminPort) {}
+
+    /**
+     * 入力状態を送信（変化したセクションのみ、変化がなければ送信しない）
+     */
+    bool send(const ControllerInput& input) {
+        char body[320];
+        size_t length = formatState(input, hasSent ? &lastSent : nullptr, body, sizeof(body));
+        if (length == 0) return true;
+
+        if (!post(controller, port, "/controller", body, length)) return false;
+        lastSent = input;
+        hasSent = true;
+        return true;
+    }
+
+    /**
+     * フレームをまとめ送り用に追加（durationMs保持、上限に達したら自動で送信）
+     */
+    bool queueFrame(const ControllerInput& input, uint16_t durationMs) {
+        if (batchCount == CLIENT_BATCH_MAX && !flushFrames()) return false;
+
+        // 直前のフレームからの差分のみ（最初のフレームは全セクション）
+        char frame[352];
+        size_t length = formatState(input, batchCount > 0 ? &batchLast : nullptr, frame, sizeof(frame) - 24);
+        if (length == 0) {
+            length = snprintf(frame, sizeof(frame), "{\"duration\":%u}", durationMs);
+        } else {
+            // 閉じ括弧を保持時間に置き換え
+            length = length - 1 + snprintf(frame + length - 1, sizeof(frame) - length + 1, ",\"duration\":%u}", durationMs);
+        }
+
+        // "{"frames":[" + フレーム + "]}" がバッファに収まらなければ先に送信
+        if (batchLength + length + 3 > sizeof(batchBody) && (batchCount == 0 || !flushFrames())) return false;
+        if (batchCount == 0) {
+            batchLength = snprintf(batchBody, sizeof(batchBody), "{\"frames\":[");
+        } else {
+            batchBody[batchLength++] = ',';
+        }
+        memcpy(batchBody + batchLength, frame, length);
+        batchLength += length;
+        batchLast = input;
+        batchCount++;
+        return true;
+    }
+
+    /**
+     * まとめたフレームを/timelineへ1リクエストで送信
+     */
+    bool flushFrames() {
+        if (batchCount == 0) return true;
+
+        batchBody[batchLength++] = ']';
+        batchBody[batchLength++] = '}';
+        bool ok = post(admin, adminPort, "/timeline", batchBody, batchLength);
+        batchCount = 0;
+        batchLength = 0;
+        return ok;
+    }
+
+    /**
+     * 往復時間の統計
+     */
+    const RttStats& stats() const { return rtt; }
+
+    void resetStats() { rtt = RttStats(); }
+
+private:
+    const char* host;
+    uint16_t port;
+    uint16_t adminPort;
+    WiFiClient controller;   // /controller用の接続（維持）
+    WiFiClient admin;        // /timeline用の接続（維持）
+    ControllerInput lastSent;
+    bool hasSent = false;
+    RttStats rtt;
+
+    char batchBody[CLIENT_BATCH_BUFFER];
+    size_t batchLength = 0;
+    size_t batchCount = 0;
+    ControllerInput batchLast;
+
+    // outのn文字目以降に書式付きで追記
+    static void appendf(char* out, size_t size, size_t& n, const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(out + n, n < size ? size - n : 0, format, args);
+        va_end(args);
+        if (written > 0) n += written;
+    }
+
+    // previousと異なるセクションのみJSONに書き出し（previous=nullptrなら全セクション、変化なしなら0）
+    static size_t formatState(const ControllerInput& in, const ControllerInput* previous, char* out, size_t size) {
+        size_t n = 0;
+        appendf(out, size, n, "{");
+        if (!previous || in.a != previous->a || in.b != previous->b || in.x != previous->x || in.y != previous->y) {
+            appendf(out, size, n, "\"buttons\":{\"A\":%s,\"B\":%s,\"X\":%s,\"Y\":%s},",
+                    bool_str(in.a), bool_str(in.b), bool_str(in.x), bool_str(in.y));
+        }
+        if (!previous || in.lstickX != previous->lstickX || in.lstickY != previous->lstickY) {
+            appendf(out, size, n, "\"lstick\":{\"x\":%d,\"y\":%d},", constrain(in.lstickX, -100, 100), constrain(in.lstickY, -100, 100));
+        }
+        if (!previous || in.rstickX != previous->rstickX || in.rstickY != previous->rstickY) {
+            appendf(out, size, n, "\"rstick\":{\"x\":%d,\"y\":%d},", constrain(in.rstickX, -100, 100), constrain(in.rstickY, -100, 100));
+        }
+        if (!previous || in.l != previous->l || in.r != previous->r || in.zl != previous->zl || in.zr != previous->zr) {
+            appendf(out, size, n, "\"shoulder\":{\"L\":%s,\"R\":%s,\"ZL\":%s,\"ZR\":%s},",
+                    bool_str(in.l), bool_str(in.r), bool_str(in.zl), bool_str(in.zr));
+        }
+        if (!previous || in.plus != previous->plus || in.minus != previous->minus || in.home != previous->home) {
+            appendf(out, size, n, "\"system\":{\"plus\":%s,\"minus\":%s,\"home\":%s},",
+                    bool_str(in.plus), bool_str(in.minus), bool_str(in.home));
+        }
+        if (n <= 1 || n >= size) return 0;
+        out[n - 1] = '}';   // 末尾の","を閉じ括弧に置き換え
+        return n;
+    }
+
+    static const char* bool_str(bool value) { return value ? "true" : "false"; }
+
+    bool connect(WiFiClient& client, uint16_t clientPort) {
+        if (client.connected()) return true;
+        client.stop();
+        if (!client.connect(host, clientPort, CLIENT_TIMEOUT_MS)) return false;
+        client.setNoDelay(true);
+        return true;
+    }
+
+    // 1リクエスト送信してレスポンスを読み切る（切断されていたら1回だけ再接続して再送）
+    bool post(WiFiClient& client, uint16_t clientPort, const char* path, const char* body, size_t length) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            if (!connect(client, clientPort)) break;
+
+            uint32_t start = micros();
+            char head[160];
+            int headLength = snprintf(head, sizeof(head),
+                                      "POST %s HTTP/1.1\r\nHost: %s\r\nContent-Type: application/json\r\n"
+                                      "Content-Length: %u\r\n\r\n",
+                                      path, host, (unsigned)length);
+            if (client.write((const uint8_t*)head, headLength) != (size_t)headLength ||
+                client.write((const uint8_t*)body, length) != length) {
+                client.stop();
+                continue;
+            }
+
+            int status = readResponse(client);
+            if (status < 0) {
+                // 送信前に切断されていた（サーバー側のタイムアウト等）
+                client.stop();
+                continue;
+            }
+            recordRtt(micros() - start);
+            if (status != 200) {
+                Serial.printf("✗ 送信失敗: %d %s\n", status, path);
+            }
+            return status == 200;
+        }
+        rtt.failures++;
+        return false;
+    }
+
+    // ステータスコードを返し、本文は読み捨てる（失敗時-1）
+    int readResponse(WiFiClient& client) {
+        char line[128];
+        int status = -1;
+        size_t contentLength = 0;
+        bool keepAlive = true;
+
+        uint32_t deadline = millis() + CLIENT_TIMEOUT_MS;
+        bool first = true;
+        for (;;) {
+            size_t n = readLine(client, line, sizeof(line), deadline);
+            if (n == (size_t)-1) return -1;
+            if (n == 0) break;   // ヘッダー終端
+            if (first) {
+                if (sscanf(line, "HTTP/1.%*d %d", &status) != 1) return -1;
+                first = false;
+            } else if (strncasecmp(line, "Content-Length:", 15) == 0) {
+                contentLength = strtoul(line + 15, nullptr, 10);
+            } else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line, "close") != nullptr) {
+                keepAlive = false;
+            }
+        }
+
+        while (contentLength > 0) {
+            if ((int32_t)(millis() - deadline) >= 0) return -1;
+            int available = client.available();
+            if (available <= 0) {
+                delay(1);
+                continue;
+            }
+            char discard[64];
+            int read = client.read((uint8_t*)discard, min((size_t)available, min(contentLength, sizeof(discard))));
+            if (read > 0) contentLength -= read;
+        }
+
+        if (!keepAlive) {
+            client.stop();
+        }
+        return status;
+    }
+
+    static size_t readLine(WiFiClient& client, char* line, size_t size, uint32_t deadline) {
+        size_t n = 0;
+        for (;;) {
+            if (client.available() <= 0) {
+                if (!client.connected() || (int32_t)(millis() - deadline) >= 0) return (size_t)-1;
+                delay(1);
+                continue;
+            }
+            char c = client.read();
+            if (c == '\n') break;
+            if (c != '\r' && n < size - 1) line[n++] = c;
+        }
+        line[n] = '\0';
+        return n;
+    }
+
+    void recordRtt(uint32_t us) {
+        if (rtt.count == 0 || us < rtt.min_us) rtt.min_us = us;
+        if (us > rtt.max_us) rtt.max_us = us;
+        rtt.last_us = us;
+        rtt.total_us += us;
+        rtt.count++;
+    }
+};
+
+SwitchControllerClient controllerClient(controllerIP, controllerPort, adminPort);
 
 // 関数の前方宣言
 bool sendControllerInput(bool btnA = false, bool btnB = false, bool btnX = false, bool btnY = false,
@@ -26,69 +284,52 @@ bool sendControllerInput(bool btnA = false, bool btnB = false, bool btnX = false
                         bool btnPlus = false, bool btnMinus = false, bool btnHome = false);
 void connectWiFi();
 void interactiveMode();
+void printRttStats();
 
 /**
- * コントローラー入力をM5AtomS3に送信
+ * コントローラー入力をM5AtomS3に送信（指定しなかった入力はニュートラル）
  */
 bool sendControllerInput(bool btnA, bool btnB, bool btnX, bool btnY,
                         int lstickX, int lstickY, int rstickX, int rstickY,
                         bool btnL, bool btnR, bool btnZL, bool btnZR,
                         bool btnPlus, bool btnMinus, bool btnHome) {
+    ControllerInput input;
+    input.a = btnA;
+    input.b = btnB;
+    input.x = btnX;
+    input.y = btnY;
+    input.lstickX = lstickX;
+    input.lstickY = lstickY;
+    input.rstickX = rstickX;
+    input.rstickY = rstickY;
+    input.l = btnL;
+    input.r = btnR;
+    input.zl = btnZL;
+    input.zr = btnZR;
+    input.plus = btnPlus;
+    input.minus = btnMinus;
+    input.home = btnHome;
     
-    // JSON作成
-    DynamicJsonDocument doc(512);
-    
-    // ボタン情報
-    JsonObject buttons = doc.createNestedObject("buttons");
-    buttons["A"] = btnA;
-    buttons["B"] = btnB;
-    buttons["X"] = btnX;
-    buttons["Y"] = btnY;
-    
-    // 左スティック情報
-    JsonObject lstick = doc.createNestedObject("lstick");
-    lstick["x"] = constrain(lstickX, -100, 100);
-    lstick["y"] = constrain(lstickY, -100, 100);
-    
-    // 右スティック情報
-    JsonObject rstick = doc.createNestedObject("rstick");
-    rstick["x"] = constrain(rstickX, -100, 100);
-    rstick["y"] = constrain(rstickY, -100, 100);
-    
-    // ショルダーボタン情報
-    JsonObject shoulder = doc.createNestedObject("shoulder");
-    shoulder["L"] = btnL;
-    shoulder["R"] = btnR;
-    shoulder["ZL"] = btnZL;
-    shoulder["ZR"] = btnZR;
-    
-    // システムボタン情報
-    JsonObject system = doc.createNestedObject("system");
-    system["plus"] = btnPlus;
-    system["minus"] = btnMinus;
-    system["home"] = btnHome;
-    
-    // JSON文字列に変換
-    String jsonString;
-    serializeJson(doc, jsonString);
-    
-    // HTTP POST送信
-    http.begin(controllerURL);
-    http.addHeader("Content-Type", "application/json");
-    
-    int httpResponseCode = http.POST(jsonString);
-    
-    if (httpResponseCode == 200) {
-        Serial.println("✓ 送信成功: " + jsonString);
-        http.end();
-        return true;
-    } else {
-        Serial.println("✗ 送信失敗: " + String(httpResponseCode));
-        String response = http.getString();
-        Serial.println("Response: " + response);
-        http.end();
-        return false;
+    bool ok = controllerClient.send(input);
+    if (ok) {
+        Serial.printf("✓ 送信成功 (RTT %.2f ms)\n", controllerClient.stats().last_us / 1000.0);
+    }
+    return ok;
+}
+
+/**
+ * 往復時間の統計を表示
+ */
+void printRttStats() {
+    const RttStats& stats = controllerClient.stats();
+    if (stats.count == 0) {
+        Serial.println("まだ送信していません");
+        return;
     }
+    Serial.printf("RTT: count=%lu failures=%lu last=%.2fms min=%.2fms avg=%.2fms max=%.2fms\n",
+                  (unsigned long)stats.count, (unsigned long)stats.failures,
+                  stats.last_us / 1000.0, stats.min_us / 1000.0,
+                  (double)stats.total_us / stats.count / 1000.0, stats.max_us / 1000.0);
 }
 
 /**
@@ -131,6 +372,8 @@ void interactiveMode() {
     Serial.println("  w,a,s,d       - 左スティック移動 (上,左,下,右)");
     Serial.println("  i,j,k,l       - 右スティック移動 (上,左,下,右)");
     Serial.println("  reset         - すべてのスティックをリセット(中央)");
+    Serial.println("  combo         - A→B→Aを50ms間隔で1リクエストにまとめて送信");
+    Serial.println("  stats         - 往復時間（RTT）の統計");
     Serial.println();
     
     while (true) {
@@ -226,6 +469,23 @@ void interactiveMode() {
             else if (cmd.equalsIgnoreCase("reset")) {
                 sendControllerInput();
             }
+            // まとめ送り（A→B→Aを50ms間隔、1リクエストでタイムラインへ）
+            else if (cmd.equalsIgnoreCase("combo")) {
+                ControllerInput pressA, pressB, neutral;
+                pressA.a = true;
+                pressB.b = true;
+                controllerClient.queueFrame(pressA, 50);
+                controllerClient.queueFrame(neutral, 50);
+                controllerClient.queueFrame(pressB, 50);
+                controllerClient.queueFrame(neutral, 50);
+                controllerClient.queueFrame(pressA, 50);
+                controllerClient.queueFrame(neutral, 50);
+                Serial.println(controllerClient.flushFrames() ? "✓ シーケンス送信" : "✗ シーケンス送信失敗");
+            }
+            // 往復時間の統計
+            else if (cmd.equalsIgnoreCase("stats")) {
+                printRttStats();
+            }
             else {
                 Serial.println("無効なコマンドです");
             }
@@ -271,7 +531,7 @@ void setup() {
     connectWiFi();
     
     Serial.print("接続先: ");
-    Serial.println(controllerURL);
+    Serial.printf("http://%s:%u/controller\n", controllerIP, controllerPort);
     Serial.println();
     
     // 接続テスト
@@ -7,6 +7,67 @@
 // M5AtomS3のIPアドレスを設定してください
 const CONTROLLER_IP = "192.168.1.100";  // ← M5AtomS3のIPアドレスに変更
 const CONTROLLER_URL = `http://${CONTROLLER_IP}/controller`;
+const CONTROLLER_WS_URL = `ws://${CONTROLLER_IP}:81/`;  // src/env.h の WS_INPUT_PORT
+
+/**
+ * WebSocketによる常時接続ストリーム
+ * 同じイベントループ周回内の複数の更新は最新状態1回の送信にまとめる
+ * （Node.js 22以上の組み込みWebSocketを使用）
+ */
+class ControllerStream {
+    constructor(url = CONTROLLER_WS_URL) {
+        this.url = url;
+        this.socket = null;
+        this.pending = null;
+        this.seq = 0;
+        this.lastEcho = null;  // 最後に反映された状態 {frame, seq, buttons, ...}
+    }
+
+    /**
+     * 接続（WebSocket非対応環境・接続失敗時はfalse）
+     * @returns {Promise<boolean>}
+     */
+    connect() {
+        if (typeof WebSocket === 'undefined') return Promise.resolve(false);
+
+        return new Promise(resolve => {
+            this.socket = new WebSocket(this.url);
+            this.socket.onopen = () => resolve(true);
+            this.socket.onerror = () => resolve(false);
+            this.socket.onmessage = (event) => {
+                this.lastEcho = JSON.parse(event.data);
+            };
+        });
+    }
+
+    get connected() {
+        return this.socket !== null && this.socket.readyState === WebSocket.OPEN;
+    }
+
+    /**
+     * 状態を送信キューへ（次の周回でまとめて送信）
+     * @param {Object} payload - /controller と同じ形式のJSON
+     */
+    update(payload) {
+        const scheduled = this.pending !== null;
+        this.pending = payload;
+        if (scheduled) return;
+
+        setImmediate(() => {
+            const latest = this.pending;
+            this.pending = null;
+            if (this.connected) {
+                this.socket.send(JSON.stringify({ seq: ++this.seq, ...latest }));
+            }
+        });
+    }
+
+    close() {
+        if (this.socket) this.socket.close();
+    }
+}
+
+const stream = new ControllerStream();
 
 /**
  * コントローラー入力をM5AtomS3に送信
@@ -27,6 +88,12 @@ async function sendControllerInput(buttons = {}, lstick = {}, rstick = {}, shoul
         system: { plus: false, minus: false, home: false, ...system }
     };
 
+    // WebSocket接続中はストリームで送信
+    if (stream.connected) {
+        stream.update(payload);
+        return true;
+    }
+
     try {
         const response = await fetch(CONTROLLER_URL, {
             method: 'POST',
@@ -88,6 +155,7 @@ async function interactiveMode() {
                 await sendControllerInput();
                 console.log('プログラム終了');
                 rl.close();
+                stream.close();
                 return;
             }
             
@@ -191,6 +259,11 @@ async function testConnection() {
     }
     
     console.log('接続成功!');
+
+    // 以降の入力はWebSocketで送信（失敗時はHTTPのまま）
+    if (await stream.connect()) {
+        console.log(`WebSocket接続: ${CONTROLLER_WS_URL}`);
+    }
     return true;
 }
 
@@ -220,6 +293,7 @@ if (typeof require !== 'undefined' && require.main === module) {
 if (typeof module !== 'undefined' && module.exports) {
     module.exports = {
         sendControllerInput,
+        ControllerStream,
         interactiveMode,
         testConnection
     };
@@ -12,6 +12,130 @@ import sys
 # M5AtomS3のIPアドレスを設定してください
 CONTROLLER_IP = "192.168.1.100"  # ← M5AtomS3のIPアドレスに変更
 CONTROLLER_URL = f"http://{CONTROLLER_IP}/controller"
+ADMIN_URL = f"http://{CONTROLLER_IP}:8080"  # /timeline、/macro等（WEB_ADMIN_PORT）
+TIMELINE_URL = f"{ADMIN_URL}/timeline"
+MACRO_URL = f"{ADMIN_URL}/macro"
+TURBO_URL = f"{ADMIN_URL}/turbo"
+MACRO_CHUNK_FRAMES = 256  # 1リクエストの最大フレーム数（TIMELINE_MAX_FRAMES）
+
+# 各セクションのニュートラル状態
+NEUTRAL = {
+    "buttons": {"A": False, "B": False, "X": False, "Y": False},
+    "lstick": {"x": 0, "y": 0},
+    "rstick": {"x": 0, "y": 0},
+    "shoulder": {"L": False, "R": False, "ZL": False, "ZR": False},
+    "system": {"plus": False, "minus": False, "home": False},
+}
+
+
+def full_state(buttons=None, lstick=None, rstick=None, shoulder=None, system=None):
+    """指定しなかったセクションをニュートラルで補った全セクションの状態"""
+    given = {"buttons": buttons, "lstick": lstick, "rstick": rstick, "shoulder": shoulder, "system": system}
+    state = {}
+    for section, neutral in NEUTRAL.items():
+        # セクション内で指定しなかったキーもニュートラル（デバイスと同じ扱い）
+        state[section] = {**neutral, **(given[section] or {})}
+    return state
+
+
+def changed_sections(state, previous):
+    """previousから変化したセクションのみ（previous=Noneなら全セクション）"""
+    if previous is None:
+        return dict(state)
+    return {section: value for section, value in state.items() if previous.get(section) != value}
+
+
+class ControllerClient:
+    """
+    コントローラーAPIクライアント
+
+    - requests.Sessionで接続を維持（keep-alive）し、毎回のTCP接続を省く
+    - 前回送信した状態から変化したセクションのみ送信（変化がなければ送信しない）
+    - queue_frame()で複数フレームをまとめ、flush()で/timelineへ1リクエストで送信
+    - 送信ごとの往復時間（RTT）を記録（rtt_stats()で集計）
+    """
+
+    def __init__(self, ip=CONTROLLER_IP, port=80, admin_port=8080, timeout=5, batch_max=MACRO_CHUNK_FRAMES):
+        self.controller_url = f"http://{ip}:{port}/controller"
+        self.timeline_url = f"http://{ip}:{admin_port}/timeline"
+        self.timeout = timeout
+        self.batch_max = batch_max
+        self.session = requests.Session()
+        self.session.headers["Content-Type"] = "application/json"
+        self.last_sent = None
+        self.rtts_ms = []
+        self.failures = 0
+        self.batch = []
+        self.batch_last = None
+
+    def _post(self, url, payload):
+        body = json.dumps(payload, separators=(",", ":"))
+        start = time.perf_counter()
+        try:
+            response = self.session.post(url, data=body, timeout=self.timeout)
+        except requests.exceptions.RequestException:
+            self.failures += 1
+            raise
+        self.rtts_ms.append((time.perf_counter() - start) * 1000)
+        return response
+
+    def send(self, state):
+        """全セクションの状態を送信（実際に送るのは変化したセクションのみ）。成功時True"""
+        payload = changed_sections(state, self.last_sent)
+        if not payload:
+            return True
+        response = self._post(self.controller_url, payload)
+        if response.status_code != 200:
+            print(f"✗ 送信失敗: {response.status_code} - {response.text}")
+            return False
+        self.last_sent = state
+        return True
+
+    def queue_frame(self, state, duration_ms):
+        """フレームをまとめ送り用に追加（batch_maxに達したら自動でflush）"""
+        frame = changed_sections(state, self.batch_last)
+        frame["duration"] = duration_ms
+        self.batch.append(frame)
+        self.batch_last = state
+        if len(self.batch) >= self.batch_max:
+            return self.flush()
+        return None
+
+    def flush(self):
+        """まとめたフレームを/timelineへ1リクエストで送信（登録結果、失敗時None）"""
+        if not self.batch:
+            return None
+        frames, self.batch, self.batch_last = self.batch, [], None
+        response = self._post(self.timeline_url, {"frames": frames})
+        if response.status_code != 200:
+            print(f"✗ 登録失敗: {response.status_code} - {response.text}")
+            return None
+        return response.json()
+
+    def rtt_stats(self):
+        """往復時間の集計（ms）"""
+        if not self.rtts_ms:
+            return {"count": 0, "failures": self.failures}
+        values = sorted(self.rtts_ms)
+        pick = lambda p: values[min(len(values) - 1, int(round(p / 100 * (len(values) - 1))))]
+        return {
+            "count": len(values),
+            "failures": self.failures,
+            "last_ms": round(self.rtts_ms[-1], 3),
+            "min_ms": round(values[0], 3),
+            "p50_ms": round(pick(50), 3),
+            "p90_ms": round(pick(90), 3),
+            "p99_ms": round(pick(99), 3),
+            "max_ms": round(values[-1], 3),
+        }
+
+    def close(self):
+        self.session.close()
+
+
+# サンプル全体で共有するクライアント（接続を使い回す）
+client = ControllerClient()
+
 
 def send_controller_input(buttons=None, lstick=None, rstick=None, shoulder=None, system=None):
     """
@@ -23,38 +147,92 @@ def send_controller_input(buttons=None, lstick=None, rstick=None, shoulder=None,
         rstick (dict): 右スティック {"x": int(-100~100), "y": int(-100~100)}
         shoulder (dict): ショルダーボタン {"L": bool, "R": bool, "ZL": bool, "ZR": bool}
         system (dict): システムボタン {"plus": bool, "minus": bool, "home": bool}
+        指定しなかったセクションはニュートラル（前回から変化したセクションのみ送信）
     
     Returns:
         bool: 送信成功時True
     """
+    state = full_state(buttons, lstick, rstick, shoulder, system)
+    try:
+        if client.send(state):
+            print(f"✓ 送信成功: {state} (RTT {client.rtts_ms[-1] if client.rtts_ms else 0:.2f} ms)")
+            return True
+        return False
+    except requests.exceptions.RequestException as e:
+        print(f"✗ 接続エラー: {e}")
+        return False
+
+def send_timeline(frames):
+    """
+    時間指定の入力シーケンスを送信（デバイス側のタイマーで再生）
     
-    # デフォルト値設定
-    payload = {
-        "buttons": buttons if buttons else {"A": False, "B": False, "X": False, "Y": False},
-        "lstick": lstick if lstick else {"x": 0, "y": 0},
-        "rstick": rstick if rstick else {"x": 0, "y": 0},
-        "shoulder": shoulder if shoulder else {"L": False, "R": False, "ZL": False, "ZR": False},
-        "system": system if system else {"plus": False, "minus": False, "home": False}
-    }
+    Args:
+        frames (list): フレームのリスト。各フレームは /controller と同じ形式 + "duration"(ms)
+            例: [{"buttons": {"A": True}, "duration": 50}, {"buttons": {"A": False}, "duration": 100}]
     
+    Returns:
+        dict: 登録結果（"id" = シーケンスID, "queued" = キュー内フレーム数）、失敗時None
+    """
     try:
-        response = requests.post(
-            CONTROLLER_URL,
-            json=payload,
-            headers={"Content-Type": "application/json"},
-            timeout=5
-        )
-        
+        response = client.session.post(TIMELINE_URL, json={"frames": frames}, timeout=5)
         if response.status_code == 200:
-            print(f"✓ 送信成功: {payload}")
-            return True
-        else:
-            print(f"✗ 送信失敗: {response.status_code} - {response.text}")
-            return False
-            
+            return response.json()
+        print(f"✗ 登録失敗: {response.status_code} - {response.text}")
     except requests.exceptions.RequestException as e:
         print(f"✗ 接続エラー: {e}")
-        return False
+    return None
+
+def wait_timeline(sequence_id, poll_interval=0.05):
+    """指定したシーケンスの再生完了を待つ"""
+    while True:
+        status = client.session.get(TIMELINE_URL, timeout=5).json()
+        # 停止中、または後続のシーケンスに進んでいれば完了
+        if not status["playing"] or status["current_id"] > sequence_id:
+            return status
+        time.sleep(poll_interval)
+
+def abort_timeline():
+    """再生中のシーケンスを中断"""
+    return client.session.delete(TIMELINE_URL, timeout=5).json()
+
+def upload_macro(name, frames):
+    """
+    マクロをデバイスのフラッシュに保存（長いマクロは分割して追記）
+    
+    Args:
+        name (str): マクロ名（英数字・'_'・'-'、24文字まで）
+        frames (list): send_timeline と同じ形式のフレームのリスト
+    
+    Returns:
+        dict: 保存結果（"frames", "duration_ms", "bytes"）、失敗時None
+    """
+    result = None
+    for i in range(0, len(frames), MACRO_CHUNK_FRAMES):
+        params = {"name": name, "append": "1" if i > 0 else "0"}
+        chunk = frames[i:i + MACRO_CHUNK_FRAMES]
+        response = client.session.post(f"{MACRO_URL}/upload", params=params, json={"frames": chunk}, timeout=10)
+        if response.status_code != 200:
+            print(f"✗ 保存失敗: {response.status_code} - {response.text}")
+            return None
+        result = response.json()
+    return result
+
+def start_macro(name, repeat=1):
+    """保存済みマクロを再生（repeat=0で停止するまで繰り返し）"""
+    return client.session.post(f"{MACRO_URL}/start", params={"name": name, "repeat": repeat}, timeout=5).json()
+
+def stop_macro():
+    """マクロ再生を停止"""
+    return client.session.post(f"{MACRO_URL}/stop", timeout=5).json()
+
+def start_turbo(button, hz=10, duty=50):
+    """デバイス側で連打を開始（押下・解放はレポート周期に合わせる）"""
+    return client.session.post(TURBO_URL, params={"button": button, "hz": hz, "duty": duty}, timeout=5).json()
+
+def stop_turbo(button=None):
+    """連打を停止（button省略時は全ボタン）"""
+    params = {"button": button} if button else None
+    return client.session.delete(TURBO_URL, params=params, timeout=5).json()
 
 def interactive_mode():
     """インタラクティブモード"""
@@ -66,6 +244,8 @@ def interactive_mode():
     print("  w,a,s,d       - 左スティック移動 (上,左,下,右)")
     print("  i,j,k,l       - 右スティック移動 (上,左,下,右)")
     print("  reset         - すべてのスティックをリセット(中央)")
+    print("  combo         - タイムラインでA→B→Aを50ms間隔で入力（1リクエストにまとめ送り）")
+    print("  stats         - 往復時間（RTT）の統計")
     print("  quit          - 終了")
     print()
     
@@ -128,6 +308,19 @@ def interactive_mode():
                 send_controller_input(rstick={"x": 0, "y": -100})  # 下方向（修正: 100 → -100）
             elif cmd == "l":
                 send_controller_input(rstick={"x": 100, "y": 0})
+            # タイムライン（デバイス側で正確なタイミングで再生）
+            elif cmd == "combo":
+                # 6フレームを1リクエストにまとめて送信
+                for button in ["A", "B", "A"]:
+                    client.queue_frame(full_state(buttons={button: True}), 50)
+                    client.queue_frame(full_state(), 50)
+                result = client.flush()
+                if result:
+                    print(f"✓ シーケンス登録: id={result['id']}")
+                    print(f"✓ 再生完了: {wait_timeline(result['id'])}")
+            # 往復時間の統計
+            elif cmd == "stats":
+                print(client.rtt_stats())
             # リセット
             elif cmd == "reset":
                 send_controller_input()
@@ -139,6 +332,8 @@ def interactive_mode():
     
     # 終了時にすべてリセット
     send_controller_input()
+    print(f"RTT: {client.rtt_stats()}")
+    client.close()
     print("プログラム終了")
 
 def main():
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Nintendo Switch Controller UDP API - Python Client Sample
+M5AtomS3 SwitchControllerにバイナリUDPフレームで入力を送信するサンプル
+（HTTP /controller より低遅延・高頻度。パケットロス対策として直近の状態を再送）
+"""
+
+import socket
+import struct
+import time
+
+# M5AtomS3のIPアドレスを設定してください
+CONTROLLER_IP = "192.168.1.100"  # ← M5AtomS3のIPアドレスに変更
+UDP_PORT = 4210                  # src/env.h の UDP_INPUT_PORT
+
+FRAME_MAGIC = 0x5753   # "SW"
+FRAME_VERSION = 1
+MAX_STATES = 4         # src/env.h の UDP_MAX_STATES
+
+# ボタンビット（src/switch_report.h と同じ）
+BUTTONS = {
+    "Y": 0x0001, "B": 0x0002, "A": 0x0004, "X": 0x0008,
+    "L": 0x0010, "R": 0x0020, "ZL": 0x0040, "ZR": 0x0080,
+    "minus": 0x0100, "plus": 0x0200, "lclick": 0x0400, "rclick": 0x0800,
+    "home": 0x1000, "capture": 0x2000,
+}
+HAT_NEUTRAL = 8
+
+HEADER = struct.Struct("<HBBII")   # magic, version, count, seq, client_time_ms
+STATE = struct.Struct("<HBBhhhh")  # buttons, hat, reserved, lx, ly, rx, ry
+
+
+class UdpController:
+    """シーケンス番号付きでコントローラー状態を送信するクライアント"""
+
+    def __init__(self, ip=CONTROLLER_IP, port=UDP_PORT, redundancy=MAX_STATES - 1):
+        self.addr = (ip, port)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.seq = 0
+        self.redundancy = min(redundancy, MAX_STATES - 1)
+        self.history = []  # 直近の状態（新しい順）
+        self.start = time.monotonic()
+
+    def send(self, buttons=(), hat=HAT_NEUTRAL, lstick=(0, 0), rstick=(0, 0)):
+        """
+        現在の状態を送信
+
+        Args:
+            buttons (iterable): 押下中のボタン名 ("A", "ZR", "plus" 等)
+            hat (int): 十字キー (0=上 〜 7=左上, 8=ニュートラル)
+            lstick (tuple): 左スティック (x, y) -100〜100、上が正
+            rstick (tuple): 右スティック (x, y) -100〜100、上が正
+        """
+        mask = 0
+        for name in buttons:
+            mask |= BUTTONS[name]
+
+        state = STATE.pack(mask, hat, 0, lstick[0], lstick[1], rstick[0], rstick[1])
+        self.history.insert(0, state)
+        del self.history[self.redundancy + 1:]
+
+        self.seq = (self.seq + 1) & 0xFFFFFFFF
+        client_time = int((time.monotonic() - self.start) * 1000) & 0xFFFFFFFF
+        header = HEADER.pack(FRAME_MAGIC, FRAME_VERSION, len(self.history), self.seq, client_time)
+        self.sock.sendto(header + b"".join(self.history), self.addr)
+
+
+def main():
+    controller = UdpController()
+    print(f"送信先: udp://{CONTROLLER_IP}:{UDP_PORT}")
+
+    # A+ZR同時押しを100ms、その後左スティックを1秒かけて一周
+    controller.send(buttons=("A", "ZR"))
+    time.sleep(0.1)
+    controller.send()
+
+    import math
+    for i in range(125):
+        angle = 2 * math.pi * i / 125
+        controller.send(lstick=(int(100 * math.cos(angle)), int(100 * math.sin(angle))))
+        time.sleep(0.008)
+
+    controller.send()
+    print("完了")
+
+
+if __name__ == "__main__":
+    main()
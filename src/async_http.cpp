@@ -0,0 +1,207 @@
+#include "async_http.h"
+#include "http_request.h"
+#include "web_server.h"
+#include "metrics.h"
+#include "input_clock.h"
+#include "hal.h"
+#include "env.h"
+#include <AsyncTCP.h>
+
+// 接続ごとの受信状態（固定バッファ、接続時に空きスロットを割り当て）
+struct AsyncHttpConnection {
+    AsyncClient *client = nullptr;
+    size_t length = 0;
+    uint32_t stamp = 0;        // リクエスト先頭の受信時刻（受信時間の計測用）
+    char buffer[ASYNC_HTTP_BUFFER];
+};
+
+static AsyncServer httpServer(WEB_SERVER_PORT);
+static AsyncHttpConnection connections[ASYNC_HTTP_MAX_CLIENTS];
+static AsyncHttpStats httpStats;
+static portMUX_TYPE httpMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 固定レスポンス
+static const char REPLY_NOT_FOUND[] = "{\"error\":\"Not found\"}";
+static const char REPLY_BAD_REQUEST[] = "{\"error\":\"Bad request\"}";
+static const char REPLY_TOO_LARGE[] = "{\"error\":\"Request too large\"}";
+static const char REPLY_MOVED[] = "{\"status\":\"Moved\"}";
+static const char REPLY_PREFLIGHT[] =
+    "HTTP/1.1 204 No Content\r\nAccess-Control-Allow-Origin: *\r\n"
+    "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\nAccess-Control-Allow-Headers: Content-Type\r\n"
+    "Content-Length: 0\r\nConnection: keep-alive\r\n\r\n";
+
+static void countStat(uint32_t AsyncHttpStats::*field, int delta) {
+    portENTER_CRITICAL(&httpMux);
+    httpStats.*field += delta;
+    portEXIT_CRITICAL(&httpMux);
+}
+
+static void sendReply(AsyncClient *client, int code, const char *contentType, const char *body, size_t length,
+                      bool keepAlive, const char *location = nullptr) {
+    char head[256];
+    size_t n = formatHttpResponseHead(head, sizeof(head), code, contentType, length, keepAlive, location);
+    if (n == 0 || client->space() < n + length) {
+        // 送信バッファに入りきらない（応答途中で切れるよりは切断）
+        client->close(true);
+        return;
+    }
+    client->add(head, n);
+    client->add(body, length);
+    client->send();
+    if (!keepAlive) {
+        client->close();
+    }
+}
+
+// /controller・/time・/以外は管理用ポート（WebServer）へ転送
+static void sendRedirect(AsyncClient *client, const HttpRequest &request) {
+    char location[128];
+    IPAddress ip = WiFi.localIP();
+    int n = snprintf(location, sizeof(location), "http://%u.%u.%u.%u:%d%.*s",
+                     ip[0], ip[1], ip[2], ip[3], WEB_ADMIN_PORT,
+                     (int)request.target_length, request.path);
+    if (n <= 0 || (size_t)n >= sizeof(location)) {
+        sendReply(client, 404, "application/json", REPLY_NOT_FOUND, sizeof(REPLY_NOT_FOUND) - 1, request.keep_alive);
+        return;
+    }
+    // 本文を受信しきっていない可能性があるため接続は閉じる
+    sendReply(client, 307, "application/json", REPLY_MOVED, sizeof(REPLY_MOVED) - 1, false, location);
+}
+
+static void handleRequest(AsyncHttpConnection &conn, const HttpRequest &request) {
+    AsyncClient *client = conn.client;
+    countStat(&AsyncHttpStats::requests, 1);
+
+    if (httpRequestIs(request, "POST", "/controller")) {
+        // 本文まで受信した時点が受信完了（解析・公開はこのタスク内でloop()を待たない）
+        recordStage(METRIC_HTTP_RECEIVE, conn.stamp);
+        uint32_t handlerStamp = metricsStamp();
+        char buffer[CONTROLLER_REPLY_SIZE];
+        const char *reply;
+        size_t replyLength;
+        int code = processControllerBody(request.body, request.body_length, buffer, sizeof(buffer),
+                                         reply, replyLength);
+        if (code == 200) recordStage(METRIC_HTTP_PARSE, handlerStamp);
+        sendReply(client, code, "application/json", reply, replyLength, request.keep_alive);
+    } else if (httpRequestIs(request, "GET", "/time")) {
+        // 時刻同期（受信時刻はloop()を待たないこのタスクで取得）
+        int64_t receiveUs = halMicros();
+        char json[160];
+        size_t length = formatClockSync(json, sizeof(json), receiveUs);
+        sendReply(client, 200, "application/json", json, length, request.keep_alive);
+    } else if (httpRequestIs(request, "GET", "/")) {
+        sendReply(client, 200, "text/html", ROOT_PAGE_HTML, ROOT_PAGE_HTML_LENGTH, request.keep_alive);
+    } else if (request.method_length == 7 && memcmp(request.method, "OPTIONS", 7) == 0) {
+        // CORSプリフライト
+        client->write(REPLY_PREFLIGHT, sizeof(REPLY_PREFLIGHT) - 1);
+    } else {
+        sendRedirect(client, request);
+    }
+}
+
+// 受信済みのリクエストを全て処理（パイプライン対応）
+static void processRequests(AsyncHttpConnection &conn) {
+    while (conn.client != nullptr && conn.length > 0) {
+        HttpRequest request;
+        HttpParseResult result = parseHttpRequest(conn.buffer, conn.length, sizeof(conn.buffer), request);
+        if (result == HTTP_PARSE_INCOMPLETE) return;
+
+        if (result != HTTP_PARSE_OK) {
+            countStat(&AsyncHttpStats::errors, 1);
+            if (result == HTTP_PARSE_TOO_LARGE) {
+                sendReply(conn.client, 413, "application/json", REPLY_TOO_LARGE, sizeof(REPLY_TOO_LARGE) - 1, false);
+            } else {
+                sendReply(conn.client, 400, "application/json", REPLY_BAD_REQUEST, sizeof(REPLY_BAD_REQUEST) - 1, false);
+            }
+            conn.length = 0;
+            return;
+        }
+
+        bool keepAlive = request.keep_alive;
+        handleRequest(conn, request);
+        if (!keepAlive) {
+            conn.length = 0;
+            return;
+        }
+
+        // 処理済みのリクエストを詰める（続きがあればその先頭から計測）
+        memmove(conn.buffer, conn.buffer + request.total, conn.length - request.total);
+        conn.length -= request.total;
+        conn.stamp = metricsStamp();
+    }
+}
+
+static void onData(void *arg, AsyncClient *client, void *data, size_t len) {
+    AsyncHttpConnection &conn = *(AsyncHttpConnection *)arg;
+    if (conn.length == 0) {
+        conn.stamp = metricsStamp();
+    }
+
+    if (len > sizeof(conn.buffer) - conn.length) {
+        countStat(&AsyncHttpStats::errors, 1);
+        sendReply(client, 413, "application/json", REPLY_TOO_LARGE, sizeof(REPLY_TOO_LARGE) - 1, false);
+        conn.length = 0;
+        return;
+    }
+    memcpy(conn.buffer + conn.length, data, len);
+    conn.length += len;
+    processRequests(conn);
+}
+
+static void onDisconnect(void *arg, AsyncClient *client) {
+    AsyncHttpConnection *conn = (AsyncHttpConnection *)arg;
+    if (conn != nullptr) {
+        conn->client = nullptr;
+        conn->length = 0;
+        countStat(&AsyncHttpStats::active, -1);
+    }
+    delete client;
+}
+
+static void onTimeout(void *arg, AsyncClient *client, uint32_t time) {
+    client->close();
+}
+
+static void onClient(void *arg, AsyncClient *client) {
+    AsyncHttpConnection *conn = nullptr;
+    for (AsyncHttpConnection &slot : connections) {
+        if (slot.client == nullptr) {
+            conn = &slot;
+            break;
+        }
+    }
+
+    if (conn == nullptr) {
+        // 空きがなければ拒否（WebServerのように順番待ちさせない）
+        countStat(&AsyncHttpStats::rejected, 1);
+        client->onDisconnect(onDisconnect, nullptr);
+        client->close(true);
+        return;
+    }
+
+    conn->client = client;
+    conn->length = 0;
+    countStat(&AsyncHttpStats::accepted, 1);
+    countStat(&AsyncHttpStats::active, 1);
+
+    // 小さな応答をすぐ送る（Nagle無効）
+    client->setNoDelay(true);
+    client->setRxTimeout(ASYNC_HTTP_IDLE_TIMEOUT);
+    client->onData(onData, conn);
+    client->onDisconnect(onDisconnect, conn);
+    client->onTimeout(onTimeout, conn);
+}
+
+void initAsyncHttp() {
+    // WiFi接続前でも待ち受けを開始（接続・再接続後にそのまま受信）
+    httpServer.setNoDelay(true);
+    httpServer.onClient(onClient, nullptr);
+    httpServer.begin();
+}
+
+AsyncHttpStats getAsyncHttpStats() {
+    portENTER_CRITICAL(&httpMux);
+    AsyncHttpStats copy = httpStats;
+    portEXIT_CRITICAL(&httpMux);
+    return copy;
+}
@@ -0,0 +1,25 @@
+#ifndef ASYNC_HTTP_H
+#define ASYNC_HTTP_H
+
+#include "types.h"
+
+// 非同期HTTPの統計
+struct AsyncHttpStats {
+    uint32_t accepted = 0;     // 受け付けた接続数
+    uint32_t active = 0;       // 現在の接続数
+    uint32_t rejected = 0;     // 同時接続数の上限で拒否した接続数
+    uint32_t requests = 0;     // 処理したリクエスト数
+    uint32_t errors = 0;       // 不正・過大なリクエスト数
+};
+
+/**
+ * 非同期HTTP初期化（WEB_SERVER_PORTで/controller・/time・/を受け付け）
+ */
+void initAsyncHttp();
+
+/**
+ * 非同期HTTPの統計を取得
+ */
+AsyncHttpStats getAsyncHttpStats();
+
+#endif // ASYNC_HTTP_H
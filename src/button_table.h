@@ -0,0 +1,160 @@
+#ifndef BUTTON_TABLE_H
+#define BUTTON_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "switch_report.h"
+#include "controller_state.h"
+
+// 入力の種類（ButtonDescriptor::bitの意味が変わる）
+enum ButtonKind : uint8_t {
+    BUTTON_KIND_BUTTON = 0,    // ボタン（bit = SWITCH_BTN_*）
+    BUTTON_KIND_DPAD,          // 十字キー（bit = DPAD_*、レポートではHATに変換）
+    BUTTON_KIND_STICK,         // スティック（bit = STICK_LEFT/STICK_RIGHT、JSONはx/y）
+    BUTTON_KIND_STICK_DIR,     // タッチ用の左スティック方向（bit = DPAD_*、±100に倒す）
+};
+
+// 十字キー・スティック方向のビット
+#define DPAD_UP     0x01
+#define DPAD_DOWN   0x02
+#define DPAD_LEFT   0x04
+#define DPAD_RIGHT  0x08
+
+// スティックの識別（BUTTON_KIND_STICKのbit）
+#define STICK_LEFT  0
+#define STICK_RIGHT 1
+
+// タッチボタンの位置（CoreS3のタッチモード）
+struct TouchRect {
+    int16_t x, y, w, h;
+};
+
+// 入力1つ分の定義（JSON解析・最新入力・タッチ・画面表示で共通）
+struct ButtonDescriptor {
+    uint8_t id;                // InputId
+    uint8_t kind;              // ButtonKind
+    uint16_t bit;              // 種類ごとのビット（ButtonKind参照）
+    const char *section;       // JSONのセクション（nullptrならJSONなし）
+    const char *key;           // JSONのキー
+    const char *name;          // 表示名（最新入力）
+    const char *label;         // タッチボタンのラベル（nullptrなら画面に配置しない）
+    TouchRect touch;           // タッチボタンの位置
+    uint32_t color;            // ボタンカラー（RGB888）
+    uint32_t pressed_color;    // 押下時カラー（RGB888）
+};
+
+// 全入力の定義。タッチボタン（labelあり）を先頭に並べ、その番号をタッチボタンの番号とする
+// JSONは同じセクションを連続して並べる（セクションの検索を1回にするため）
+static constexpr ButtonDescriptor BUTTON_TABLE[] = {
+    // Nintendo Switch ボタン
+    { INPUT_A, BUTTON_KIND_BUTTON, SWITCH_BTN_A, "buttons", "A", "A", "A", {240, 120, 70, 50}, 0x00FF00, 0x00AA00 },
+    { INPUT_B, BUTTON_KIND_BUTTON, SWITCH_BTN_B, "buttons", "B", "B", "B", {240, 180, 70, 50}, 0xFF0000, 0xAA0000 },
+    { INPUT_X, BUTTON_KIND_BUTTON, SWITCH_BTN_X, "buttons", "X", "X", "X", {160, 120, 70, 50}, 0x0000FF, 0x0000AA },
+    { INPUT_Y, BUTTON_KIND_BUTTON, SWITCH_BTN_Y, "buttons", "Y", "Y", "Y", {160, 180, 70, 50}, 0xFFFF00, 0xAAAA00 },
+
+    // 左スティック（タッチのみ）
+    { INPUT_STICK_L, BUTTON_KIND_STICK_DIR, DPAD_UP, nullptr, nullptr, "STICK_L", "↑", {60, 100, 50, 40}, 0x00CED1, 0x008B8D },
+    { INPUT_STICK_L, BUTTON_KIND_STICK_DIR, DPAD_DOWN, nullptr, nullptr, "STICK_L", "↓", {60, 180, 50, 40}, 0x00CED1, 0x008B8D },
+    { INPUT_STICK_L, BUTTON_KIND_STICK_DIR, DPAD_LEFT, nullptr, nullptr, "STICK_L", "←", {10, 140, 40, 50}, 0x00CED1, 0x008B8D },
+    { INPUT_STICK_L, BUTTON_KIND_STICK_DIR, DPAD_RIGHT, nullptr, nullptr, "STICK_L", "→", {110, 140, 40, 50}, 0x00CED1, 0x008B8D },
+
+    // ショルダーボタン
+    { INPUT_L, BUTTON_KIND_BUTTON, SWITCH_BTN_L, "shoulder", "L", "L", "L", {112, 100, 38, 35}, 0x795548, 0x4E342E },
+    { INPUT_R, BUTTON_KIND_BUTTON, SWITCH_BTN_R, "shoulder", "R", "R", "R", {160, 88, 70, 28}, 0x795548, 0x4E342E },
+    { INPUT_ZL, BUTTON_KIND_BUTTON, SWITCH_BTN_ZL, "shoulder", "ZL", "ZL", "ZL", {10, 100, 40, 35}, 0x795548, 0x4E342E },
+    { INPUT_ZR, BUTTON_KIND_BUTTON, SWITCH_BTN_ZR, "shoulder", "ZR", "ZR", "ZR", {240, 88, 70, 28}, 0x795548, 0x4E342E },
+
+    // システムボタン
+    { INPUT_PLUS, BUTTON_KIND_BUTTON, SWITCH_BTN_PLUS, "system", "plus", "+", "+", {280, 60, 35, 25}, 0x9C27B0, 0x6A1B9A },
+    { INPUT_MINUS, BUTTON_KIND_BUTTON, SWITCH_BTN_MINUS, "system", "minus", "-", "-", {5, 60, 35, 25}, 0x9C27B0, 0x6A1B9A },
+    { INPUT_HOME, BUTTON_KIND_BUTTON, SWITCH_BTN_HOME, "system", "home", "HOME", "H", {280, 30, 35, 25}, 0x607D8B, 0x455A64 },
+    { INPUT_CAPTURE, BUTTON_KIND_BUTTON, SWITCH_BTN_CAPTURE, "system", "capture", "CAPTURE", "C", {5, 30, 35, 25}, 0x607D8B, 0x455A64 },
+
+    // スティック（x/y）・スティック押し込み
+    { INPUT_STICK_L, BUTTON_KIND_STICK, STICK_LEFT, "lstick", nullptr, "STICK_L", nullptr, {0, 0, 0, 0}, 0, 0 },
+    { INPUT_L3, BUTTON_KIND_BUTTON, SWITCH_BTN_LCLICK, "lstick", "press", "L3", nullptr, {0, 0, 0, 0}, 0, 0 },
+    { INPUT_STICK_R, BUTTON_KIND_STICK, STICK_RIGHT, "rstick", nullptr, "STICK_R", nullptr, {0, 0, 0, 0}, 0, 0 },
+    { INPUT_R3, BUTTON_KIND_BUTTON, SWITCH_BTN_RCLICK, "rstick", "press", "R3", nullptr, {0, 0, 0, 0}, 0, 0 },
+
+    // 十字キー
+    { INPUT_DPAD_UP, BUTTON_KIND_DPAD, DPAD_UP, "dpad", "up", "UP", nullptr, {0, 0, 0, 0}, 0, 0 },
+    { INPUT_DPAD_DOWN, BUTTON_KIND_DPAD, DPAD_DOWN, "dpad", "down", "DOWN", nullptr, {0, 0, 0, 0}, 0, 0 },
+    { INPUT_DPAD_LEFT, BUTTON_KIND_DPAD, DPAD_LEFT, "dpad", "left", "LEFT", nullptr, {0, 0, 0, 0}, 0, 0 },
+    { INPUT_DPAD_RIGHT, BUTTON_KIND_DPAD, DPAD_RIGHT, "dpad", "right", "RIGHT", nullptr, {0, 0, 0, 0}, 0, 0 },
+};
+
+#define BUTTON_COUNT (sizeof(BUTTON_TABLE) / sizeof(BUTTON_TABLE[0]))
+
+// 先頭から連続するタッチボタン（labelあり）の数
+static constexpr size_t countTouchButtons(size_t i = 0) {
+    return i < BUTTON_COUNT && BUTTON_TABLE[i].label != nullptr ? 1 + countTouchButtons(i + 1) : 0;
+}
+
+// i番目以降にタッチボタンがないか
+static constexpr bool noTouchButtonsFrom(size_t i) {
+    return i >= BUTTON_COUNT || (BUTTON_TABLE[i].label == nullptr && noTouchButtonsFrom(i + 1));
+}
+
+static constexpr size_t TOUCH_BUTTON_COUNT = countTouchButtons();
+
+static_assert(noTouchButtonsFrom(TOUCH_BUTTON_COUNT), "touch buttons must be at the head of BUTTON_TABLE");
+static_assert(TOUCH_BUTTON_COUNT * 2 <= 32, "touch button draw state must fit in 32 bits");
+
+// 十字キーの方向ビット → HAT値（逆方向の同時押しは打ち消し）
+static constexpr uint8_t DPAD_TO_HAT[16] = {
+    SWITCH_HAT_NEUTRAL,     // なし
+    SWITCH_HAT_UP,          // 上
+    SWITCH_HAT_DOWN,        // 下
+    SWITCH_HAT_NEUTRAL,     // 上下
+    SWITCH_HAT_LEFT,        // 左
+    SWITCH_HAT_UP_LEFT,     // 上左
+    SWITCH_HAT_DOWN_LEFT,   // 下左
+    SWITCH_HAT_LEFT,        // 上下左
+    SWITCH_HAT_RIGHT,       // 右
+    SWITCH_HAT_UP_RIGHT,    // 上右
+    SWITCH_HAT_DOWN_RIGHT,  // 下右
+    SWITCH_HAT_RIGHT,       // 上下右
+    SWITCH_HAT_NEUTRAL,     // 左右
+    SWITCH_HAT_UP,          // 上左右
+    SWITCH_HAT_DOWN,        // 下左右
+    SWITCH_HAT_NEUTRAL,     // 全方向
+};
+
+// HAT値 → 十字キーの方向ビット（範囲外はニュートラル）
+static constexpr uint8_t HAT_TO_DPAD[SWITCH_HAT_NEUTRAL + 1] = {
+    DPAD_UP,
+    DPAD_UP | DPAD_RIGHT,
+    DPAD_RIGHT,
+    DPAD_DOWN | DPAD_RIGHT,
+    DPAD_DOWN,
+    DPAD_DOWN | DPAD_LEFT,
+    DPAD_LEFT,
+    DPAD_UP | DPAD_LEFT,
+    0,
+};
+
+static inline uint8_t hatToDpad(uint8_t hat) {
+    return hat <= SWITCH_HAT_NEUTRAL ? HAT_TO_DPAD[hat] : 0;
+}
+
+static inline uint8_t dpadToHat(uint8_t dpad) {
+    return DPAD_TO_HAT[dpad & 0x0F];
+}
+
+/**
+ * 入力IDの定義を取得（タッチ用のスティック方向は除く、未定義ならnullptr）
+ */
+const ButtonDescriptor *findButton(uint8_t id);
+
+/**
+ * 入力が現在アクティブか（スティックは閾値を超えて倒れているか）
+ */
+bool isButtonActive(const ControllerState &state, const ButtonDescriptor &button,
+                    int stickThreshold = STICK_ACTIVE_THRESHOLD);
+
+/**
+ * 入力1つ分の押下状態をstateに反映（スティックは変更しない）
+ */
+void setButton(ControllerState &state, const ButtonDescriptor &button, bool pressed);
+
+#endif // BUTTON_TABLE_H
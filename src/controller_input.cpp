@@ -1,148 +1,109 @@
 #include "controller_input.h"
-#include "lcd_display.h"
+#include "input_scheduler.h"
+#include "report_cycle.h"
+#include "usb_poll_sync.h"
+#include "metrics.h"
+#include <esp_timer.h>
+
+// レポート送信タスク
+static TaskHandle_t reportTaskHandle = nullptr;
+static ReportTimingStats reportStats;
+static portMUX_TYPE reportStatsMux = portMUX_INITIALIZER_UNLOCKED;
 
 void updateSwitchController() {
-    // Nintendo Switch ボタンの処理（SwitchControllerESP32ライブラリ使用）
-    // タッチ入力またはWeb入力で判定
-    
-    // A ボタン
-    bool btnA_active = btnA.current || btnA.web_input;
-    if (btnA_active != btnA.previous) {
-        if (btnA_active) {
-            pushButton2(Button::A, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnA.previous = btnA_active;
-    }
-    
-    // B ボタン
-    bool btnB_active = btnB.current || btnB.web_input;
-    if (btnB_active != btnB.previous) {
-        if (btnB_active) {
-            pushButton2(Button::B, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnB.previous = btnB_active;
-    }
-    
-    // X ボタン
-    bool btnX_active = btnX.current || btnX.web_input;
-    if (btnX_active != btnX.previous) {
-        if (btnX_active) {
-            pushButton2(Button::X, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnX.previous = btnX_active;
-    }
-    
-    // Y ボタン
-    bool btnY_active = btnY.current || btnY.web_input;
-    if (btnY_active != btnY.previous) {
-        if (btnY_active) {
-            pushButton2(Button::Y, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnY.previous = btnY_active;
-    }
-    
-    // 左スティック操作
-    // Web入力がある場合は精密制御、ない場合はタッチ入力
-    if (webButtons.lstick_x != 0 || webButtons.lstick_y != 0) {
-        // Web入力による精密制御
-        tiltJoystick(webButtons.lstick_x, -webButtons.lstick_y, 0, 0, 40, 0);
-    } else {
-        // タッチ入力による方向制御
-        bool lstickUp_active = lstickUp.current;
-        bool lstickDown_active = lstickDown.current;
-        bool lstickLeft_active = lstickLeft.current;
-        bool lstickRight_active = lstickRight.current;
-        
-        int stick_x = 0, stick_y = 0;
-        if (lstickLeft_active) stick_x = -100;
-        if (lstickRight_active) stick_x = 100;
-        if (lstickUp_active) stick_y = -100;
-        if (lstickDown_active) stick_y = 100;
-        
-        tiltJoystick(stick_x, stick_y, 0, 0, 40, 0);
-    }
-    
-    // 追加ボタン
-    bool btnPlus_active = btnPlus.current || btnPlus.web_input;
-    if (btnPlus_active != btnPlus.previous) {
-        if (btnPlus_active) {
-            pushButton2(Button::PLUS, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnPlus.previous = btnPlus_active;
-    }
-    
-    bool btnMinus_active = btnMinus.current || btnMinus.web_input;
-    if (btnMinus_active != btnMinus.previous) {
-        if (btnMinus_active) {
-            pushButton2(Button::MINUS, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnMinus.previous = btnMinus_active;
+    // 現在の全入力から1フレーム分のレポートを作成して送信（nativeと共通）
+    runReportCycle(isTimelineActive());
+}
+
+static void recordReportTiming(int64_t interval_us) {
+    int32_t jitter_us = (int32_t)(interval_us - REPORT_INTERVAL_MS * 1000);
+    uint32_t abs_jitter = jitter_us < 0 ? -jitter_us : jitter_us;
+
+    portENTER_CRITICAL(&reportStatsMux);
+    reportStats.cycles++;
+    reportStats.last_interval_us = (uint32_t)interval_us;
+    if (reportStats.cycles == 1 || interval_us < reportStats.min_interval_us) {
+        reportStats.min_interval_us = (uint32_t)interval_us;
     }
-    
-    bool btnHome_active = btnHome.current || btnHome.web_input;
-    if (btnHome_active != btnHome.previous) {
-        if (btnHome_active) {
-            pushButton2(Button::HOME, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnHome.previous = btnHome_active;
+    if (interval_us > reportStats.max_interval_us) {
+        reportStats.max_interval_us = (uint32_t)interval_us;
     }
-    
-    // ショルダーボタン（L, R, ZL, ZR）
-    bool btnL_active = webButtons.L;
-    static bool btnL_previous = false;
-    if (btnL_active != btnL_previous) {
-        if (btnL_active) {
-            pushButton2(Button::L, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnL_previous = btnL_active;
+    if (abs_jitter > reportStats.max_jitter_us) {
+        reportStats.max_jitter_us = abs_jitter;
     }
-    
-    bool btnR_active = webButtons.R;
-    static bool btnR_previous = false;
-    if (btnR_active != btnR_previous) {
-        if (btnR_active) {
-            pushButton2(Button::R, 40, 0, 1);  // 40ms押下
-            button_press_count++;
-        }
-        btnR_previous = btnR_active;
+    reportStats.total_jitter_us += abs_jitter;
+    // 1周期以上遅れた場合はオーバーラン
+    if (interval_us >= 2 * REPORT_INTERVAL_MS * 1000) {
+        reportStats.overruns++;
     }
-    
-    bool btnZL_active = webButtons.ZL;
-    static bool btnZL_previous = false;
-    if (btnZL_active != btnZL_previous) {
-        if (btnZL_active) {
-            pushButton2(Button::ZL, 40, 0, 1);  // 40ms押下
-            button_press_count++;
+    portEXIT_CRITICAL(&reportStatsMux);
+}
+
+// 起床用タイマー（ポーリングの直前にusの精度で起こすため、tick単位のvTaskDelayUntil()は使わない）
+static esp_timer_handle_t wakeTimer = nullptr;
+
+static void onWakeTimer(void *arg) {
+    xTaskNotifyGive(reportTaskHandle);
+}
+
+static void reportTask(void *param) {
+    int64_t wake = esp_timer_get_time();
+    int64_t lastCycle = 0;
+
+    for (;;) {
+        wake = nextReportWake(wake);
+        int64_t delay = wake - esp_timer_get_time();
+        if (delay > 0) {
+            esp_timer_start_once(wakeTimer, delay);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } else if (delay < -REPORT_INTERVAL_MS * 1000) {
+            // 1周期以上遅れたら追いつこうとせず今から
+            wake = esp_timer_get_time();
         }
-        btnZL_previous = btnZL_active;
-    }
-    
-    bool btnZR_active = webButtons.ZR;
-    static bool btnZR_previous = false;
-    if (btnZR_active != btnZR_previous) {
-        if (btnZR_active) {
-            pushButton2(Button::ZR, 40, 0, 1);  // 40ms押下
-            button_press_count++;
+
+        int64_t now = esp_timer_get_time();
+        if (lastCycle != 0) {
+            recordReportTiming(now - lastCycle);
         }
-        btnZR_previous = btnZR_active;
+        lastCycle = now;
+
+        updateSwitchController();
+        recordReportEmitted();
     }
 }
 
+void startReportTask() {
+    if (reportTaskHandle != nullptr) return;
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = onWakeTimer;
+    timerArgs.name = "report_wake";
+    esp_timer_create(&timerArgs, &wakeTimer);
+
+    xTaskCreatePinnedToCore(reportTask, "report", REPORT_TASK_STACK, nullptr,
+                            REPORT_TASK_PRIORITY, &reportTaskHandle, REPORT_TASK_CORE);
+}
+
+ReportTimingStats getReportTimingStats() {
+    portENTER_CRITICAL(&reportStatsMux);
+    ReportTimingStats stats = reportStats;
+    portEXIT_CRITICAL(&reportStatsMux);
+    return stats;
+}
+
+void resetReportTimingStats() {
+    portENTER_CRITICAL(&reportStatsMux);
+    reportStats = ReportTimingStats();
+    portEXIT_CRITICAL(&reportStatsMux);
+}
+
 void initController() {
     // Nintendo Switchコントローラー初期化
     switchcontrolleresp32_init();
-    
+
     // USB接続開始
     USB.begin();
-    
+
     // コントローラーリセット
     switchcontrolleresp32_reset();
-} 
\ No newline at end of file
+}
\ No newline at end of file
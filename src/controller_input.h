@@ -2,16 +2,44 @@
 #define CONTROLLER_INPUT_H
 
 #include "types.h"
+#include "switch_report.h"
+#include "report_pipeline.h"
 #include "SwitchControllerESP32.h"
 
+// レポート送信周期の計測値（周期ジッター統計）
+struct ReportTimingStats {
+    uint32_t cycles = 0;             // 計測した周期数
+    uint32_t last_interval_us = 0;   // 直近の周期（us）
+    uint32_t min_interval_us = 0;    // 最小周期（us）
+    uint32_t max_interval_us = 0;    // 最大周期（us）
+    uint32_t max_jitter_us = 0;      // 目標周期からの最大ずれ（us）
+    uint64_t total_jitter_us = 0;    // ずれの絶対値の合計（平均算出用）
+    uint32_t overruns = 0;           // 1周期以上遅れた回数
+};
+
 /**
  * Nintendo Switchコントローラー更新
  */
 void updateSwitchController();
 
+/**
+ * レポート送信タスク開始（REPORT_INTERVAL_MS周期、ホストのポーリングに同期、REPORT_TASK_COREに固定）
+ */
+void startReportTask();
+
+/**
+ * レポート送信周期の統計を取得
+ */
+ReportTimingStats getReportTimingStats();
+
+/**
+ * レポート送信周期の統計をリセット
+ */
+void resetReportTimingStats();
+
 /**
  * コントローラー初期化
  */
 void initController();
 
-#endif // CONTROLLER_INPUT_H 
\ No newline at end of file
+#endif // CONTROLLER_INPUT_H
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "controller_json.h"
+#include "button_table.h"
+#include <string.h>
+
+// 解析用固定領域（実体）
+alignas(8) static uint8_t jsonArena[JSON_INGEST_ARENA_SIZE];
+static JsonArenaAllocator jsonAllocator(jsonArena, sizeof(jsonArena));
+
+// 各ブロックの先頭にサイズを保持（reallocate時のコピー量に使用）
+static const size_t BLOCK_HEADER = 8;
+
+static size_t alignSize(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+void *JsonArenaAllocator::allocate(size_t size) {
+    size_t total = BLOCK_HEADER + alignSize(size);
+    if (used + total > capacity) return nullptr;
+
+    uint8_t *block = buffer + used;
+    memcpy(block, &size, sizeof(size));
+    used += total;
+    if (used > high_water) high_water = used;
+
+    last = block + BLOCK_HEADER;
+    return last;
+}
+
+void JsonArenaAllocator::deallocate(void *ptr) {
+    // 個別解放はしない（reset()でまとめて解放）
+    (void)ptr;
+}
+
+void *JsonArenaAllocator::reallocate(void *ptr, size_t new_size) {
+    if (ptr == nullptr) return allocate(new_size);
+
+    uint8_t *block = (uint8_t *)ptr - BLOCK_HEADER;
+    size_t old_size;
+    memcpy(&old_size, block, sizeof(old_size));
+
+    // 直前のブロックならその場で伸縮
+    if (ptr == last) {
+        size_t start = block - buffer;
+        size_t total = BLOCK_HEADER + alignSize(new_size);
+        if (start + total > capacity) return nullptr;
+
+        memcpy(block, &new_size, sizeof(new_size));
+        used = start + total;
+        if (used > high_water) high_water = used;
+        return ptr;
+    }
+
+    void *moved = allocate(new_size);
+    if (moved == nullptr) return nullptr;
+    memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    return moved;
+}
+
+static int16_t clampStick(int value) {
+    if (value < -100) return -100;
+    if (value > 100) return 100;
+    return (int16_t)value;
+}
+
+void applyControllerJson(JsonVariantConst input, ControllerState &state, uint32_t now,
+                         ControllerStateMask *mask) {
+    uint8_t latestInput = INPUT_NONE;
+
+    // 含まれるセクションの入力のみ更新（セクション内で省略したボタンは解放）
+    // 同じセクションは表で連続しているため、セクションの検索はセクションごとに1回
+    const char *sectionName = nullptr;
+    JsonObjectConst section;
+    for (const ButtonDescriptor &button : BUTTON_TABLE) {
+        if (button.section == nullptr) continue;
+        if (button.section != sectionName) {
+            sectionName = button.section;
+            section = input[sectionName];
+        }
+        if (!section) continue;
+
+        if (mask != nullptr) {
+            switch (button.kind) {
+                case BUTTON_KIND_STICK:
+                    if (button.bit == STICK_LEFT) mask->lstick = true;
+                    else mask->rstick = true;
+                    break;
+                case BUTTON_KIND_DPAD: mask->hat = true; break;
+                default: mask->buttons |= button.bit; break;
+            }
+        }
+
+        if (button.kind == BUTTON_KIND_STICK) {
+            // スティック（範囲制限、閾値を超えたら最新入力）
+            int16_t &x = button.bit == STICK_LEFT ? state.lstick_x : state.rstick_x;
+            int16_t &y = button.bit == STICK_LEFT ? state.lstick_y : state.rstick_y;
+            x = clampStick(section["x"] | 0);
+            y = clampStick(section["y"] | 0);
+            if (isButtonActive(state, button)) latestInput = button.id;
+        } else {
+            // ボタン・十字キー（押下時は最新入力として記録）
+            bool pressed = section[button.key] | false;
+            setButton(state, button, pressed);
+            if (pressed) latestInput = button.id;
+        }
+    }
+
+    // 最新入力を記録（アクティブな入力がある場合のみ）
+    if (latestInput != INPUT_NONE) {
+        state.last_input = latestInput;
+        state.update_time = now;
+    }
+}
+
+JsonIngestResult parseControllerJson(const char *body, size_t length, ControllerState &state,
+                                     uint32_t now, uint32_t *seq, int64_t *at_us, ControllerStateMask *mask) {
+    jsonAllocator.reset();
+
+    JsonDocument doc(&jsonAllocator);
+    DeserializationError error = deserializeJson(doc, body, length,
+                                                 DeserializationOption::NestingLimit(JSON_INGEST_NESTING_LIMIT));
+    if (error == DeserializationError::NoMemory) return JSON_INGEST_TOO_LARGE;
+    if (error || !doc.is<JsonObjectConst>()) return JSON_INGEST_INVALID;
+
+    applyControllerJson(doc.as<JsonVariantConst>(), state, now, mask);
+    if (seq != nullptr) {
+        *seq = doc["seq"] | (uint32_t)0;
+    }
+    if (at_us != nullptr) {
+        *at_us = doc["at_us"] | (int64_t)0;
+    }
+    return JSON_INGEST_OK;
+}
+
+size_t jsonIngestHighWater() {
+    return jsonAllocator.highWater();
+}
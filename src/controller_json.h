@@ -0,0 +1,72 @@
+#ifndef CONTROLLER_JSON_H
+#define CONTROLLER_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+#include "controller_state.h"
+
+// JSON解析用の固定領域サイズ（byte）。/controllerの全セクション入りで約1KB使用
+#ifndef JSON_INGEST_ARENA_SIZE
+#define JSON_INGEST_ARENA_SIZE 4096
+#endif
+
+// JSONのネスト上限（{"buttons":{"A":true}} は2段）
+#define JSON_INGEST_NESTING_LIMIT 3
+
+// 解析結果
+enum JsonIngestResult : uint8_t {
+    JSON_INGEST_OK = 0,
+    JSON_INGEST_INVALID,       // JSON形式不正
+    JSON_INGEST_TOO_LARGE,     // 固定領域に収まらない
+    JSON_INGEST_BAD_TIME,      // 時刻指定（at_us）が先すぎる
+    JSON_INGEST_SCHEDULE_FULL, // 時刻指定入力のキューが満杯
+};
+
+/**
+ * 固定領域からのみ確保するArduinoJson用アロケーター（解析毎にreset、ヒープ確保なし）
+ */
+class JsonArenaAllocator : public ArduinoJson::Allocator {
+public:
+    JsonArenaAllocator(uint8_t *buffer, size_t capacity) : buffer(buffer), capacity(capacity) {}
+
+    void *allocate(size_t size) override;
+    void deallocate(void *ptr) override;
+    void *reallocate(void *ptr, size_t new_size) override;
+
+    /**
+     * 領域を全て解放（JsonDocument破棄後に呼ぶこと）
+     */
+    void reset() { used = 0; last = nullptr; }
+
+    size_t highWater() const { return high_water; }
+
+private:
+    uint8_t *buffer;
+    size_t capacity;
+    size_t used = 0;
+    size_t high_water = 0;
+    uint8_t *last = nullptr;   // 直前に確保したブロック（その場で伸縮可能）
+};
+
+/**
+ * コントローラー入力JSONを固定領域で解析し、含まれるセクションのみstateへ直接反映
+ * （単一スレッドから呼ぶこと。seq/at_usが指定されていれば"seq"/"at_us"の値を返す、なければ0）
+ * maskが指定されていれば反映したフィールドを返す
+ */
+JsonIngestResult parseControllerJson(const char *body, size_t length, ControllerState &state,
+                                     uint32_t now, uint32_t *seq = nullptr, int64_t *at_us = nullptr,
+                                     ControllerStateMask *mask = nullptr);
+
+/**
+ * 解析済みJSONのセクションをstateへ反映（maskが指定されていれば反映したフィールドを追加）
+ */
+void applyControllerJson(JsonVariantConst input, ControllerState &state, uint32_t now,
+                         ControllerStateMask *mask = nullptr);
+
+/**
+ * 解析用固定領域の最大使用量（byte）
+ */
+size_t jsonIngestHighWater();
+
+#endif // CONTROLLER_JSON_H
@@ -0,0 +1,191 @@
+#include "controller_state.h"
+#include "button_table.h"
+#include "input_edges.h"
+#include <string.h>
+#include <stdlib.h>
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <mutex>
+#endif
+
+// 入力元ごとの状態（実体）
+// 入力レベルの間のタップを押下エッジでも渡す（タイムライン・マクロも1msのフレームを受け付けるため対象）
+ControllerStateChannel webInput(INPUT_SOURCE_WEB);
+ControllerStateChannel touchInput(INPUT_SOURCE_TOUCH);
+ControllerStateChannel timelineInput(INPUT_SOURCE_TIMELINE);
+
+// Web入力の書き込み排他（HTTP/WebSocket/UDPの各タスクから読み出し→更新→公開するため）
+#ifdef ESP_PLATFORM
+static StaticSemaphore_t webInputLockBuffer;
+static SemaphoreHandle_t webInputLock = xSemaphoreCreateMutexStatic(&webInputLockBuffer);
+
+void lockWebInput() {
+    xSemaphoreTake(webInputLock, portMAX_DELAY);
+}
+
+void unlockWebInput() {
+    xSemaphoreGive(webInputLock);
+}
+#else
+static std::mutex webInputLock;
+
+void lockWebInput() {
+    webInputLock.lock();
+}
+
+void unlockWebInput() {
+    webInputLock.unlock();
+}
+#endif
+
+// 書き込み側の排他（コピー中にプリエンプトされないよう短いクリティカルセクションで保護）
+#ifdef ESP_PLATFORM
+static portMUX_TYPE stateWriteMux = portMUX_INITIALIZER_UNLOCKED;
+#define STATE_WRITE_LOCK() portENTER_CRITICAL(&stateWriteMux)
+#define STATE_WRITE_UNLOCK() portEXIT_CRITICAL(&stateWriteMux)
+#else
+// ホスト環境（ベンチマーク等）ではスピンロック
+static std::atomic_flag stateWriteFlag = ATOMIC_FLAG_INIT;
+#define STATE_WRITE_LOCK() while (stateWriteFlag.test_and_set(std::memory_order_acquire)) {}
+#define STATE_WRITE_UNLOCK() stateWriteFlag.clear(std::memory_order_release)
+#endif
+
+// 読み出し再試行の上限（書き込みは数百ns程度のため通常1〜2回で成功）
+static const int STATE_READ_RETRY = 64;
+
+void ControllerStateChannel::publish(const ControllerState &newState, bool exactEdges) {
+    STATE_WRITE_LOCK();
+    if (edgeSource != INPUT_SOURCE_NONE) {
+        // 前回公開した状態（書き込み側のみ更新するためロック内で参照可）
+        pushPressedEdges(state, newState, edgeSource, exactEdges);
+    }
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&state, &newState, sizeof(ControllerState));
+    sequence.store(seq + 2, std::memory_order_release);
+    STATE_WRITE_UNLOCK();
+}
+
+bool ControllerStateChannel::read(ControllerState &out) const {
+    ControllerState copy;
+    for (int i = 0; i < STATE_READ_RETRY; i++) {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+
+        memcpy(&copy, &state, sizeof(ControllerState));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            out = copy;
+            return true;
+        }
+    }
+    return false;
+}
+
+void mergeControllerState(ControllerState &state, const ControllerState &delta, const ControllerStateMask &mask,
+                          uint32_t now) {
+    state.buttons = (state.buttons & ~mask.buttons) | (delta.buttons & mask.buttons);
+    if (mask.hat) state.hat = delta.hat;
+    if (mask.lstick) {
+        state.lstick_x = delta.lstick_x;
+        state.lstick_y = delta.lstick_y;
+    }
+    if (mask.rstick) {
+        state.rstick_x = delta.rstick_x;
+        state.rstick_y = delta.rstick_y;
+    }
+    if (delta.last_input != INPUT_NONE) {
+        state.last_input = delta.last_input;
+        state.update_time = now;
+    }
+}
+
+const ButtonDescriptor *findButton(uint8_t id) {
+    for (const ButtonDescriptor &button : BUTTON_TABLE) {
+        if (button.id == id && button.kind != BUTTON_KIND_STICK_DIR) return &button;
+    }
+    return nullptr;
+}
+
+const char *inputName(uint8_t id) {
+    const ButtonDescriptor *button = findButton(id);
+    return button != nullptr ? button->name : "";
+}
+
+bool isButtonActive(const ControllerState &state, const ButtonDescriptor &button, int stickThreshold) {
+    switch (button.kind) {
+        case BUTTON_KIND_BUTTON:
+            return state.pressed(button.bit);
+        case BUTTON_KIND_DPAD:
+            return (hatToDpad(state.hat) & button.bit) != 0;
+        case BUTTON_KIND_STICK: {
+            int x = button.bit == STICK_LEFT ? state.lstick_x : state.rstick_x;
+            int y = button.bit == STICK_LEFT ? state.lstick_y : state.rstick_y;
+            return abs(x) > stickThreshold || abs(y) > stickThreshold;
+        }
+        case BUTTON_KIND_STICK_DIR:
+            // 左スティックを指定方向へ閾値を超えて倒しているか（上が正）
+            switch (button.bit) {
+                case DPAD_UP: return state.lstick_y > stickThreshold;
+                case DPAD_DOWN: return state.lstick_y < -stickThreshold;
+                case DPAD_LEFT: return state.lstick_x < -stickThreshold;
+                case DPAD_RIGHT: return state.lstick_x > stickThreshold;
+            }
+            return false;
+    }
+    return false;
+}
+
+void setButton(ControllerState &state, const ButtonDescriptor &button, bool pressed) {
+    switch (button.kind) {
+        case BUTTON_KIND_BUTTON:
+            state.buttons = pressed ? (state.buttons | button.bit) : (state.buttons & ~button.bit);
+            break;
+        case BUTTON_KIND_DPAD: {
+            uint8_t dpad = hatToDpad(state.hat);
+            state.hat = dpadToHat(pressed ? (dpad | button.bit) : (dpad & ~button.bit));
+            break;
+        }
+        case BUTTON_KIND_STICK_DIR: {
+            // 押下で±100、解放時はその方向に倒れていれば中央へ
+            bool vertical = button.bit == DPAD_UP || button.bit == DPAD_DOWN;
+            int16_t &axis = vertical ? state.lstick_y : state.lstick_x;
+            int16_t value = (button.bit == DPAD_UP || button.bit == DPAD_RIGHT) ? 100 : -100;
+            if (pressed) {
+                axis = value;
+            } else if ((axis > 0) == (value > 0) && axis != 0) {
+                axis = 0;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool isInputActive(const ControllerState &state, uint8_t id) {
+    const ButtonDescriptor *button = findButton(id);
+    return button != nullptr && isButtonActive(state, *button);
+}
+
+void trackLatestInput(const ControllerState &previous, ControllerState &next, uint32_t now) {
+    uint8_t latest = INPUT_NONE;
+
+    // 新たに押されたボタン・倒されたスティック（表の後ろのものを優先）
+    for (const ButtonDescriptor &button : BUTTON_TABLE) {
+        if (button.kind == BUTTON_KIND_STICK_DIR) continue;
+        if (!isButtonActive(previous, button) && isButtonActive(next, button)) latest = button.id;
+    }
+
+    if (latest != INPUT_NONE) {
+        next.last_input = latest;
+        next.update_time = now;
+    } else {
+        next.last_input = previous.last_input;
+        next.update_time = previous.update_time;
+    }
+}
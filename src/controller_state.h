@@ -0,0 +1,141 @@
+#ifndef CONTROLLER_STATE_H
+#define CONTROLLER_STATE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+#include "switch_report.h"
+
+// 最新入力の識別子（表示用、Stringの代わり）
+enum InputId : uint8_t {
+    INPUT_NONE = 0,
+    INPUT_A,
+    INPUT_B,
+    INPUT_X,
+    INPUT_Y,
+    INPUT_L,
+    INPUT_R,
+    INPUT_ZL,
+    INPUT_ZR,
+    INPUT_PLUS,
+    INPUT_MINUS,
+    INPUT_HOME,
+    INPUT_STICK_L,
+    INPUT_STICK_R,
+    INPUT_L3,
+    INPUT_R3,
+    INPUT_CAPTURE,
+    INPUT_DPAD_UP,
+    INPUT_DPAD_DOWN,
+    INPUT_DPAD_LEFT,
+    INPUT_DPAD_RIGHT,
+};
+
+// スティック入力ありと判定する値（表示・最新入力追跡用）
+#define STICK_ACTIVE_THRESHOLD 10
+
+// コントローラー状態のスナップショット（ヒープ確保なし・memcpy可能）
+struct ControllerState {
+    uint16_t buttons = 0;                  // SWITCH_BTN_* のビットマスク
+    uint8_t hat = SWITCH_HAT_NEUTRAL;      // SWITCH_HAT_*
+    uint8_t last_input = INPUT_NONE;       // 最新のアクティブ入力（InputId）
+    int16_t lstick_x = 0;                  // -100 to 100
+    int16_t lstick_y = 0;                  // -100 to 100（上が正）
+    int16_t rstick_x = 0;                  // -100 to 100
+    int16_t rstick_y = 0;                  // -100 to 100（上が正）
+    uint32_t update_time = 0;              // 最終更新時刻（ms）
+
+    bool pressed(uint16_t bit) const { return (buttons & bit) != 0; }
+};
+
+static_assert(std::is_trivially_copyable<ControllerState>::value,
+              "ControllerState must be trivially copyable");
+
+// 状態のうち入力に含まれていたフィールド（一部だけを後から反映する場合の差分）
+struct ControllerStateMask {
+    uint16_t buttons = 0;                  // 対象のSWITCH_BTN_*
+    bool hat = false;                      // 十字キー
+    bool lstick = false;                   // 左スティックのx/y
+    bool rstick = false;                   // 右スティックのx/y
+};
+
+/**
+ * maskのフィールドのみdeltaからstateへ反映（deltaに最新入力があればnowで記録）
+ */
+void mergeControllerState(ControllerState &state, const ControllerState &delta, const ControllerStateMask &mask,
+                          uint32_t now);
+
+// 入力元（押下エッジの出どころ。レポートに使われている入力元の押下エッジのみ反映する）
+enum InputSource : uint8_t {
+    INPUT_SOURCE_NONE = 0,                 // 押下エッジを積まない
+    INPUT_SOURCE_WEB,                      // Web/WebSocket/UDP（時刻指定入力を含む）
+    INPUT_SOURCE_TOUCH,                    // タッチ
+    INPUT_SOURCE_TIMELINE,                 // タイムライン・マクロ
+};
+
+#define INPUT_SOURCE_BIT(source) (1u << (source))
+
+/**
+ * 入力元（Web/タッチ等）ごとの状態チャンネル
+ * 書き込みはフレーム単位で公開し、読み出しはseqlockでロックなしに一貫したスナップショットを取得する
+ */
+class ControllerStateChannel {
+public:
+    /**
+     * edgeSource: 公開時に新たに押されたボタンをこの入力元の押下エッジとしてキューに積む（レベルの間の短いタップ用）
+     */
+    explicit ControllerStateChannel(uint8_t edgeSource = INPUT_SOURCE_NONE) : edgeSource(edgeSource) {}
+
+    /**
+     * 状態を1フレーム分まとめて公開（どのコアからでも可）
+     * exactEdges: 押下エッジを最小保持時間なしの1レポートとして扱う（周期に合わせて公開する時刻指定入力用）
+     */
+    void publish(const ControllerState &state, bool exactEdges = false);
+
+    /**
+     * 一貫したスナップショットを取得（取得できなかった場合はfalse、outは変更しない）
+     */
+    bool read(ControllerState &out) const;
+
+    /**
+     * 公開回数（変化検出用）
+     */
+    uint32_t version() const { return sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+    std::atomic<uint32_t> sequence{0};  // 奇数 = 書き込み中
+    ControllerState state;
+    const uint8_t edgeSource;
+};
+
+/**
+ * 入力の表示名を取得
+ */
+const char *inputName(uint8_t id);
+
+/**
+ * 最新入力が現在もアクティブかどうか
+ */
+bool isInputActive(const ControllerState &state, uint8_t id);
+
+/**
+ * 前回状態との差分から最新入力（新たに押されたボタン/倒されたスティック）を更新
+ */
+void trackLatestInput(const ControllerState &previous, ControllerState &next, uint32_t now);
+
+/**
+ * Web入力への書き込み（読み出し→更新→公開）の排他開始
+ */
+void lockWebInput();
+
+/**
+ * Web入力への書き込みの排他終了
+ */
+void unlockWebInput();
+
+// 入力元ごとの状態（グローバル）
+extern ControllerStateChannel webInput;
+extern ControllerStateChannel touchInput;
+extern ControllerStateChannel timelineInput;
+
+#endif // CONTROLLER_STATE_H
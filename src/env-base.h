@@ -20,7 +20,35 @@
 #define WIFI_PASSWORD "YOUR_WIFI_PASSWORD" // あなたのWiFiパスワードに変更
 
 // Webサーバー設定
-#define WEB_SERVER_PORT 80
+#define WEB_SERVER_PORT 80          // 非同期HTTP（/controller、/time、/）
+#define WEB_ADMIN_PORT 8080         // WebServer（/stats、/metrics、/timeline、/macro等）
+#define ASYNC_HTTP_MAX_CLIENTS 8    // 非同期HTTPの同時接続数
+#define ASYNC_HTTP_BUFFER 2048      // 接続ごとの受信バッファ（ヘッダー＋本文）
+#define ASYNC_HTTP_IDLE_TIMEOUT 30  // 無通信で切断するまでの時間（秒）
+
+// UDPバイナリ入力設定
+#define UDP_INPUT_PORT 4210         // UDP受信ポート
+#define UDP_MAX_STATES 4            // 1パケットに含められる状態数（最新 + 再送分）
+#define UDP_SEQ_RESET_WINDOW 1000   // これ以上シーケンス番号が巻き戻ったらクライアント再起動とみなす
+#define UDP_SEQ_IDLE_MS 1000        // 送信元からこの時間受信がなければシーケンスを取り直す（ms）
+#define UDP_MAX_SENDERS 4           // シーケンスを個別に管理するUDP送信元（IPアドレス・ポート）の数
+
+// WebSocket入力設定
+#define WS_INPUT_PORT 81            // WebSocketポート
+
+// タイムライン（時間指定シーケンス）設定
+#define TIMELINE_MAX_FRAMES 256     // キューに保持できるフレーム数
+#define TIMELINE_MAX_DURATION_MS 60000 // 1フレームの最大保持時間（ms）
+
+// マクロ（LittleFS保存・ストリーミング再生）設定
+#define MACRO_IO_BUFFER 512         // ファイル読み書きバッファ（byte）
+#define MACRO_FEED_BATCH 32         // タイムラインへ一度に送るフレーム数
+#define MACRO_FEED_INTERVAL_MS 10   // キューの空き待ち間隔（ms）
+#define MACRO_LIST_MAX 32           // 一覧で返す最大数
+#define MACRO_REPEAT_MAX 100000     // 再生の最大周回数（?repeat=）
+#define MACRO_TASK_CORE 1           // 再生タスクの実行コア
+#define MACRO_TASK_PRIORITY 2       // 再生タスク優先度（loop()より上）
+#define MACRO_TASK_STACK 4096       // 再生タスクスタックサイズ（byte）
 
 // ディスプレイ設定
 #define DISPLAY_ROTATION 1
@@ -28,15 +56,58 @@
 
 // 制御設定
 #define DISPLAY_UPDATE_INTERVAL 30  // ディスプレイ更新間隔（ms）
+#define DISPLAY_TASK_CORE 0         // 表示タスクの実行コア
+#define DISPLAY_TASK_PRIORITY 1     // 表示タスク優先度（入力処理より下）
+#define DISPLAY_TASK_STACK 4096     // 表示タスクスタックサイズ（byte）
+#define DISPLAY_DMA_CANVAS_MAX 65536 // 内部RAMに確保する描画先の最大サイズ（byte、DMA転送可）
 #define MAIN_LOOP_DELAY 5           // メインループ遅延（ms）
 
+// USBレポート送信タスク設定
+#define REPORT_INTERVAL_MS 8        // レポート送信周期（ms）8ms = 125Hz
+#define REPORT_TASK_CORE 1          // 実行コア（WiFi/lwIPはコア0で動作）
+#define REPORT_TASK_PRIORITY 19     // タスク優先度（loop()=1, lwIP=18より上）
+#define REPORT_TASK_STACK 4096      // タスクスタックサイズ（byte）
+#define REPORT_KEEPALIVE_MS 100     // 変化がなくても送信する間隔（ms）。0なら毎周期送信
+
+// ホストのUSBポーリングへの同期（IN転送の完了時刻からポーリング時刻を予測し、その直前にレポートを作成）
+#define ENABLE_USB_POLL_SYNC true   // true: 同期する（false: REPORT_INTERVAL_MSの固定周期）
+#define USB_POLL_INTERVAL_US 8000   // ホストのポーリング間隔（us）
+#define USB_POLL_LEAD_US 500        // ポーリングの何us前にレポートを作成するか
+#define USB_POLL_MIN_WAIT_US 50     // 送信から完了までがこれ未満ならポーリングを待っていないとみなす（us）
+#define USB_POLL_LOCK_SAMPLES 8     // 同期を始めるまでに必要な完了時刻の数
+#define INPUT_EDGE_QUEUE_SIZE 32    // 押下エッジのキューに保持できるイベント数（2のべき乗）
+#define INPUT_SCHEDULE_MAX 32       // 時刻指定入力（at_us）を保持できる数
+#define INPUT_SCHEDULE_MAX_AHEAD_MS 10000 // 受け付ける時刻指定の最大先行時間（ms）
+#define INPUT_EDGE_MIN_HOLD_MS 16   // 周期の間に離されたボタンをレポートで押下のまま保持する最小時間（ms）。0なら1レポート分
+
 // WiFi接続設定
-#define WIFI_CONNECT_TIMEOUT 30     // WiFi接続タイムアウト（試行回数）
-#define WIFI_RECONNECT_TIMEOUT 10   // WiFi再接続タイムアウト（試行回数）
+#define WIFI_ATTEMPT_TIMEOUT_MS 10000 // 1回の接続試行でIP取得を待つ時間（ms）
+#define WIFI_BACKOFF_MIN_MS 500     // 切断・接続失敗後の最初の再試行待ち（ms）
+#define WIFI_BACKOFF_MAX_MS 30000   // 再試行待ちの上限（失敗ごとに倍）（ms）
 
 // 左スティック設定
 #define LSTICK_THRESHOLD 50         // Web入力時の左スティック閾値
 
+// スティックのジッターバッファ（UDP/WebSocketバイナリでclient_time_ms付きのスティック入力を一定遅延で再生）
+#define ENABLE_STICK_JITTER_BUFFER false // true: 使用する
+#define STICK_JITTER_DEPTH_MS 0     // 再生遅延（ms）。0なら受信の揺らぎと送信間隔から自動調整
+#define STICK_JITTER_MIN_MS 8       // 自動調整時の最小遅延（ms）
+#define STICK_JITTER_MAX_MS 80      // 自動調整時の最大遅延（ms）
+#define STICK_JITTER_SAMPLES 32     // バッファに保持するサンプル数
+#define STICK_JITTER_IDLE_MS 500    // 受信がこの時間途切れたらバッファを破棄（ms）
+
+// スティックの応答カーブ・デッドゾーン（stick_curve.hのSTICK_PROFILESから選択、POST /stickで変更可）
+#define STICK_PROFILE_LEFT "linear"  // 左スティック
+#define STICK_PROFILE_RIGHT "linear" // 右スティック
+
+// 連打（POST /turbo、押下・解放はレポート周期に合わせる）
+#define TURBO_MAX_PERIOD_MS 10000   // 受け付ける最長の周期（ms）。最短はレポート周期2回
+
+// 長時間稼働試験（ヒープの推移を記録、GET /soak）
+#define ENABLE_SOAK_TEST false      // true: 記録する
+#define SOAK_SAMPLE_INTERVAL_MS 300000 // 記録間隔（ms）5分
+#define SOAK_SAMPLE_COUNT 288       // 保持するサンプル数（5分×288 = 24時間）
+
 
 
 
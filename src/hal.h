@@ -0,0 +1,25 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include "switch_report.h"
+
+// ハードウェア抽象化（ESP32: hal_esp32.cpp、Linux: native/hal_native.cpp）
+// 共通ロジック（JSON解析・状態チャンネル・レポート作成）はここだけを経由して実機に依存する
+
+/**
+ * 起動からの経過時間（ms）
+ */
+uint32_t halMillis();
+
+/**
+ * 起動からの経過時間（us）
+ */
+int64_t halMicros();
+
+/**
+ * レポートをHIDへ送信（ホストがポーリングで受け取るまで待つ。戻った時刻をIN転送の完了時刻とする）
+ */
+void halSendReport(const SwitchReport &report);
+
+#endif // HAL_H
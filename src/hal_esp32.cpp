@@ -0,0 +1,29 @@
+#include "hal.h"
+#include "SwitchControllerESP32.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+
+uint32_t halMillis() {
+    return millis();
+}
+
+int64_t halMicros() {
+    return esp_timer_get_time();
+}
+
+void halSendReport(const SwitchReport &report) {
+    // ライブラリの低レベルAPIでレポート全体を組み立てて1回で送信（ボタンごとの固定の待ちはない）
+    // ただしsendReport()はUSBHIDのSendReport()でIN転送の完了（ホストのポーリング）まで待つため、
+    // 最大1ポーリング間隔ブロックする。所要時間はCPU時間ではない
+    for (uint16_t bit = SWITCH_BTN_Y; bit <= SWITCH_BTN_CAPTURE; bit <<= 1) {
+        if (report.buttons & bit) {
+            SwitchControlLibrary().pressButton(bit);
+        } else {
+            SwitchControlLibrary().releaseButton(bit);
+        }
+    }
+    SwitchControlLibrary().moveHat(report.hat);
+    SwitchControlLibrary().moveLeftStick(report.lx, report.ly);
+    SwitchControlLibrary().moveRightStick(report.rx, report.ry);
+    SwitchControlLibrary().sendReport();
+}
@@ -0,0 +1,133 @@
+#include "http_request.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+// ヘッダー終端（空行）の直後の位置（見つからなければ0）
+static size_t findHeaderEnd(const char *buffer, size_t length) {
+    for (size_t i = 3; i < length; i++) {
+        if (buffer[i] == '\n' && buffer[i - 1] == '\r' && buffer[i - 2] == '\n' && buffer[i - 3] == '\r') {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// ヘッダー内の指定フィールドの値（前後の空白を除く）
+static bool findHeader(const char *headers, const char *end, const char *name,
+                       const char *&value, size_t &valueLength) {
+    size_t nameLength = strlen(name);
+    for (const char *line = headers; line < end; ) {
+        const char *eol = (const char *)memchr(line, '\n', end - line);
+        if (eol == nullptr) break;
+        if ((size_t)(eol - line) > nameLength && strncasecmp(line, name, nameLength) == 0 && line[nameLength] == ':') {
+            value = line + nameLength + 1;
+            while (value < eol && *value == ' ') value++;
+            const char *valueEnd = eol;
+            while (valueEnd > value && (valueEnd[-1] == '\r' || valueEnd[-1] == ' ')) valueEnd--;
+            valueLength = valueEnd - value;
+            return true;
+        }
+        line = eol + 1;
+    }
+    return false;
+}
+
+// Content-Lengthの値（10進数のみ。空・符号・数字以外・size_tを超える値はfalse）
+static bool parseContentLength(const char *value, size_t valueLength, size_t &out) {
+    if (valueLength == 0) return false;
+    size_t result = 0;
+    for (size_t i = 0; i < valueLength; i++) {
+        char c = value[i];
+        if (c < '0' || c > '9') return false;
+        size_t digit = (size_t)(c - '0');
+        if (result > (SIZE_MAX - digit) / 10) return false;
+        result = result * 10 + digit;
+    }
+    out = result;
+    return true;
+}
+
+static const char *httpReason(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 307: return "Temporary Redirect";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 503: return "Service Unavailable";
+        default: return "Error";
+    }
+}
+
+HttpParseResult parseHttpRequest(const char *buffer, size_t length, size_t capacity, HttpRequest &request) {
+    size_t headerLength = findHeaderEnd(buffer, length);
+    if (headerLength == 0) {
+        // ヘッダーがバッファに収まらない
+        return length < capacity ? HTTP_PARSE_INCOMPLETE : HTTP_PARSE_TOO_LARGE;
+    }
+    const char *headerEnd = buffer + headerLength;
+
+    // リクエスト行: METHOD SP PATH[?QUERY] SP HTTP/1.x
+    const char *lineEnd = (const char *)memchr(buffer, '\r', headerLength);
+    const char *space = (const char *)memchr(buffer, ' ', lineEnd - buffer);
+    if (space == nullptr || space == buffer) return HTTP_PARSE_INVALID;
+    const char *target = space + 1;
+    const char *targetEnd = (const char *)memchr(target, ' ', lineEnd - target);
+    if (targetEnd == nullptr || targetEnd == target) return HTTP_PARSE_INVALID;
+    const char *version = targetEnd + 1;
+    if (lineEnd - version != 8 || strncmp(version, "HTTP/1.", 7) != 0) return HTTP_PARSE_INVALID;
+
+    const char *query = (const char *)memchr(target, '?', targetEnd - target);
+    request.method = buffer;
+    request.method_length = space - buffer;
+    request.path = target;
+    request.path_length = (query != nullptr ? query : targetEnd) - target;
+    request.target_length = targetEnd - target;
+
+    // 本文（Content-Lengthのみ対応、chunkedは非対応）
+    const char *value;
+    size_t valueLength;
+    size_t bodyLength = 0;
+    if (findHeader(lineEnd, headerEnd, "Transfer-Encoding", value, valueLength)) return HTTP_PARSE_INVALID;
+    if (findHeader(lineEnd, headerEnd, "Content-Length", value, valueLength) &&
+        !parseContentLength(value, valueLength, bodyLength)) {
+        return HTTP_PARSE_INVALID;
+    }
+    // 加算で桁あふれしないよう残り容量と比較
+    if (headerLength > capacity || bodyLength > capacity - headerLength) return HTTP_PARSE_TOO_LARGE;
+    if (length < headerLength + bodyLength) return HTTP_PARSE_INCOMPLETE;
+
+    request.body = headerEnd;
+    request.body_length = bodyLength;
+    request.total = headerLength + bodyLength;
+
+    // HTTP/1.1は既定でkeep-alive、HTTP/1.0は明示された場合のみ
+    bool http11 = version[7] == '1';
+    if (findHeader(lineEnd, headerEnd, "Connection", value, valueLength)) {
+        request.keep_alive = http11 ? strncasecmp(value, "close", 5) != 0 : strncasecmp(value, "keep-alive", 10) == 0;
+    } else {
+        request.keep_alive = http11;
+    }
+    return HTTP_PARSE_OK;
+}
+
+bool httpRequestIs(const HttpRequest &request, const char *method, const char *path) {
+    size_t methodLength = strlen(method);
+    size_t pathLength = strlen(path);
+    return request.method_length == methodLength && memcmp(request.method, method, methodLength) == 0 &&
+           request.path_length == pathLength && memcmp(request.path, path, pathLength) == 0;
+}
+
+size_t formatHttpResponseHead(char *out, size_t size, int code, const char *contentType,
+                              size_t length, bool keepAlive, const char *location) {
+    int n = snprintf(out, size,
+                     "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n%s%s%s"
+                     "Access-Control-Allow-Origin: *\r\nConnection: %s\r\n\r\n",
+                     code, httpReason(code), contentType, (unsigned)length,
+                     location != nullptr ? "Location: " : "", location != nullptr ? location : "",
+                     location != nullptr ? "\r\n" : "",
+                     keepAlive ? "keep-alive" : "close");
+    return n > 0 && (size_t)n < size ? (size_t)n : 0;
+}
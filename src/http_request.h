@@ -0,0 +1,44 @@
+#ifndef HTTP_REQUEST_H
+#define HTTP_REQUEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 受信バッファ内のHTTPリクエスト（各ポインタは受信バッファを指す）
+struct HttpRequest {
+    const char *method = nullptr;
+    size_t method_length = 0;
+    const char *path = nullptr;        // リクエストターゲット先頭
+    size_t path_length = 0;            // クエリ文字列を除く長さ
+    size_t target_length = 0;          // クエリ文字列を含む長さ
+    const char *body = nullptr;
+    size_t body_length = 0;
+    size_t total = 0;                  // ヘッダー＋本文の長さ（次のリクエストの位置）
+    bool keep_alive = false;
+};
+
+// 解析結果
+enum HttpParseResult : uint8_t {
+    HTTP_PARSE_INCOMPLETE = 0,   // ヘッダーまたは本文の残りを待つ
+    HTTP_PARSE_OK,
+    HTTP_PARSE_TOO_LARGE,        // 受信バッファに収まらない
+    HTTP_PARSE_INVALID,
+};
+
+/**
+ * 受信バッファ先頭のHTTP/1.xリクエストを解析（capacityは受信バッファの大きさ）
+ */
+HttpParseResult parseHttpRequest(const char *buffer, size_t length, size_t capacity, HttpRequest &request);
+
+/**
+ * メソッドとパスが一致するか
+ */
+bool httpRequestIs(const HttpRequest &request, const char *method, const char *path);
+
+/**
+ * レスポンスのステータス行・ヘッダーを書き出し（書き込んだ文字数を返す、locationは転送先）
+ */
+size_t formatHttpResponseHead(char *out, size_t size, int code, const char *contentType,
+                              size_t length, bool keepAlive, const char *location = nullptr);
+
+#endif // HTTP_REQUEST_H
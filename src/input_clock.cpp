@@ -0,0 +1,113 @@
+#include "input_clock.h"
+#include "hal.h"
+#include "env.h"
+#include <stdio.h>
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#endif
+
+// キューの排他（追加はHTTP/WebSocket側、取り出しはレポート送信側）
+#ifdef ESP_PLATFORM
+static portMUX_TYPE scheduleMux = portMUX_INITIALIZER_UNLOCKED;
+#define SCHEDULE_LOCK() portENTER_CRITICAL(&scheduleMux)
+#define SCHEDULE_UNLOCK() portEXIT_CRITICAL(&scheduleMux)
+#else
+static std::atomic_flag scheduleFlag = ATOMIC_FLAG_INIT;
+#define SCHEDULE_LOCK() while (scheduleFlag.test_and_set(std::memory_order_acquire)) {}
+#define SCHEDULE_UNLOCK() scheduleFlag.clear(std::memory_order_release)
+#endif
+
+struct ScheduledInput {
+    int64_t at_us;
+    ControllerState delta;     // JSONに含まれていたフィールドの値
+    ControllerStateMask mask;  // 反映するフィールド
+};
+
+// 時刻順のキュー（先頭が最も早い、件数が少ないため挿入ソート）
+static ScheduledInput scheduleQueue[INPUT_SCHEDULE_MAX];
+static size_t scheduleCount = 0;
+static ScheduledInputStats scheduleStats;
+
+size_t formatClockSync(char *out, size_t size, int64_t receive_us) {
+    ReportCycle cycle = getLastReportCycle();
+    int n = snprintf(out, size,
+                     "{\"receive_us\":%lld,\"transmit_us\":%lld,\"frame\":%lu,\"frame_us\":%lld,\"interval_us\":%d}",
+                     (long long)receive_us, (long long)halMicros(),
+                     (unsigned long)cycle.frame, (long long)cycle.time_us, REPORT_INTERVAL_MS * 1000);
+    return n > 0 && (size_t)n < size ? n : 0;
+}
+
+ScheduleResult queueScheduledInput(const ControllerState &delta, const ControllerStateMask &mask, int64_t at_us,
+                                   ReportCycle &cycle) {
+    ScheduleResult result = SCHEDULE_TOO_FAR;
+    bool tooFar = at_us - halMicros() > (int64_t)INPUT_SCHEDULE_MAX_AHEAD_MS * 1000;
+
+    SCHEDULE_LOCK();
+    if (!tooFar && scheduleCount < INPUT_SCHEDULE_MAX) {
+        // 同時刻は受信順
+        size_t i = scheduleCount;
+        while (i > 0 && scheduleQueue[i - 1].at_us > at_us) {
+            scheduleQueue[i] = scheduleQueue[i - 1];
+            i--;
+        }
+        scheduleQueue[i].at_us = at_us;
+        scheduleQueue[i].delta = delta;
+        scheduleQueue[i].mask = mask;
+        scheduleCount++;
+        scheduleStats.queued++;
+        result = SCHEDULE_OK;
+    } else {
+        if (!tooFar) result = SCHEDULE_FULL;
+        scheduleStats.rejected++;
+    }
+    SCHEDULE_UNLOCK();
+
+    if (result == SCHEDULE_OK) {
+        cycle = predictReportCycle(at_us);
+    }
+    return result;
+}
+
+void applyScheduledInputs(int64_t now_us) {
+    // この周期が最も近い（次の周期より半周期以上手前の）入力が対象
+    const int64_t due = now_us + REPORT_INTERVAL_MS * 1000 / 2;
+
+    for (;;) {
+        ScheduledInput input;
+        SCHEDULE_LOCK();
+        if (scheduleCount == 0 || scheduleQueue[0].at_us > due) {
+            SCHEDULE_UNLOCK();
+            return;
+        }
+        input = scheduleQueue[0];
+        scheduleCount--;
+        for (size_t i = 0; i < scheduleCount; i++) {
+            scheduleQueue[i] = scheduleQueue[i + 1];
+        }
+        // 前の周期で反映すべきだったものは遅れ
+        int64_t late = now_us - REPORT_INTERVAL_MS * 1000 / 2 - input.at_us;
+        if (late > 0) {
+            scheduleStats.late++;
+            if (late > scheduleStats.max_late_us) scheduleStats.max_late_us = (uint32_t)late;
+        }
+        scheduleStats.applied++;
+        SCHEDULE_UNLOCK();
+
+        // 登録後のWeb/WebSocket/UDPの変更を残すため、含まれていたフィールドのみ現在の状態へ反映
+        // 同じ周期の入力も順に公開（押下エッジで周期内のタップも残る）
+        ControllerState state;
+        lockWebInput();
+        webInput.read(state);
+        mergeControllerState(state, input.delta, input.mask, halMillis());
+        webInput.publish(state, true);
+        unlockWebInput();
+    }
+}
+
+ScheduledInputStats getScheduledInputStats() {
+    SCHEDULE_LOCK();
+    ScheduledInputStats stats = scheduleStats;
+    stats.pending = scheduleCount;
+    SCHEDULE_UNLOCK();
+    return stats;
+}
@@ -0,0 +1,50 @@
+#ifndef INPUT_CLOCK_H
+#define INPUT_CLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "controller_state.h"
+#include "report_pipeline.h"
+
+// 時刻指定入力の追加結果
+enum ScheduleResult : uint8_t {
+    SCHEDULE_OK = 0,
+    SCHEDULE_TOO_FAR,          // INPUT_SCHEDULE_MAX_AHEAD_MSより先
+    SCHEDULE_FULL,             // キューが満杯
+};
+
+// 時刻指定入力の統計
+struct ScheduledInputStats {
+    uint32_t queued = 0;       // 受け付けた時刻指定入力数
+    uint32_t applied = 0;      // 反映した数
+    uint32_t late = 0;         // 指定時刻に最も近い周期を過ぎてから反映した数
+    uint32_t rejected = 0;     // キューが満杯・指定時刻が先すぎるため拒否した数
+    uint32_t max_late_us = 0;  // 指定時刻からの最大遅れ（us）
+    uint32_t pending = 0;      // キュー内の未反映数
+};
+
+/**
+ * 時刻同期の応答（JSON）を書き出し（receive_usはリクエスト受信時刻、送信時刻は書き出し時点）
+ * クライアントは送信・受信時刻と合わせてNTPと同様にオフセットと往復時間を求める
+ */
+size_t formatClockSync(char *out, size_t size, int64_t receive_us);
+
+/**
+ * 時刻at_us（デバイス時刻、halMicros()基準）に反映する入力をキューへ追加（反映予定の周期をcycleに返す）
+ * 反映するのはmaskのフィールドのみ（それ以外は反映時点のwebInputのまま）
+ */
+ScheduleResult queueScheduledInput(const ControllerState &delta, const ControllerStateMask &mask, int64_t at_us,
+                                   ReportCycle &cycle);
+
+/**
+ * 時刻がこの周期に最も近い入力を時刻順に現在のwebInputへ反映して公開（レポート作成前にレポート送信側から呼ぶ）
+ * 押下は最小保持時間（INPUT_EDGE_MIN_HOLD_MS）の対象外で、指定した周期どおりに押下・解放する
+ */
+void applyScheduledInputs(int64_t now_us);
+
+/**
+ * 時刻指定入力の統計を取得
+ */
+ScheduledInputStats getScheduledInputStats();
+
+#endif // INPUT_CLOCK_H
@@ -0,0 +1,178 @@
+#include "input_edges.h"
+#include "button_table.h"
+#include "env.h"
+#include <atomic>
+
+static_assert((INPUT_EDGE_QUEUE_SIZE & (INPUT_EDGE_QUEUE_SIZE - 1)) == 0,
+              "INPUT_EDGE_QUEUE_SIZE must be a power of two");
+
+#define EDGE_QUEUE_MASK (INPUT_EDGE_QUEUE_SIZE - 1)
+
+// イベントの最上位ビット: 最小保持時間なし（時刻指定入力）
+#define EDGE_EXACT (1u << 31)
+
+// 押下イベントのキュー（複数の入力元から書き込み、レポート送信側のみ読み出す有界リングバッファ）
+// スロットごとの番号で書き込み完了を判定する。番号は「位置 - スロット番号」で保持し、ゼロ初期化で空になる
+struct EdgeSlot {
+    std::atomic<uint32_t> turn;
+    uint32_t pressed;
+    uint8_t source;            // InputSource
+};
+
+static EdgeSlot edgeSlots[INPUT_EDGE_QUEUE_SIZE];
+static std::atomic<uint32_t> edgeHead{0};   // 次に書き込む位置
+static uint32_t edgeTail = 0;               // 次に読み出す位置（レポート送信側のみ）
+
+// 押下の保持状態（レポート送信側のみ使用）
+static uint8_t pendingPresses[INPUT_EDGE_BIT_COUNT];   // まだレポートに出していない押下数
+static uint32_t holdStart[INPUT_EDGE_BIT_COUNT];       // 押下をレポートに出した時刻（ms）
+static uint32_t holding = 0;                           // 押下を保持中のビット
+static uint32_t pending = 0;                           // 未反映の押下があるビット
+static uint32_t pendingExact = 0;                      // 未反映の押下が最小保持時間なしのビット
+static uint32_t holdingExact = 0;                      // 保持中の押下が最小保持時間なしのビット
+static uint32_t activeSources = 0;                     // 前回のレポートに使った入力元
+
+// 統計（他タスクから読み出し）
+static std::atomic<uint32_t> edgeEvents{0};
+static std::atomic<uint32_t> edgePresses{0};
+static std::atomic<uint32_t> edgeStretched{0};
+static std::atomic<uint32_t> edgeCoalesced{0};
+static std::atomic<uint32_t> edgeDropped{0};
+static std::atomic<uint32_t> edgeIgnored{0};
+
+static bool pushEdge(uint32_t pressed, uint8_t source) {
+    uint32_t pos = edgeHead.load(std::memory_order_relaxed);
+    EdgeSlot *slot;
+    for (;;) {
+        slot = &edgeSlots[pos & EDGE_QUEUE_MASK];
+        int32_t diff = (int32_t)(slot->turn.load(std::memory_order_acquire) + (pos & EDGE_QUEUE_MASK) - pos);
+        if (diff == 0) {
+            // 空きスロット。位置を確保できたら書き込む
+            if (edgeHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // 1周前のイベントが未読（満杯）
+            return false;
+        } else {
+            pos = edgeHead.load(std::memory_order_relaxed);
+        }
+    }
+    slot->pressed = pressed;
+    slot->source = source;
+    slot->turn.store(pos + 1 - (pos & EDGE_QUEUE_MASK), std::memory_order_release);
+    return true;
+}
+
+static bool popEdge(uint32_t &pressed, uint8_t &source) {
+    uint32_t index = edgeTail & EDGE_QUEUE_MASK;
+    EdgeSlot &slot = edgeSlots[index];
+    if (slot.turn.load(std::memory_order_acquire) + index != edgeTail + 1) return false;
+
+    pressed = slot.pressed;
+    source = slot.source;
+    // 次の周で書き込めるようにする
+    slot.turn.store(edgeTail + INPUT_EDGE_QUEUE_SIZE - index, std::memory_order_release);
+    edgeTail++;
+    return true;
+}
+
+// 状態のボタン・十字キーを押下エッジのビットに変換
+static uint32_t edgeBits(uint16_t buttons, uint8_t hat) {
+    return buttons | ((uint32_t)hatToDpad(hat) << INPUT_EDGE_DPAD_SHIFT);
+}
+
+void pushPressedEdges(const ControllerState &previous, const ControllerState &next, uint8_t source, bool exact) {
+    uint32_t pressed = edgeBits(next.buttons, next.hat) & ~edgeBits(previous.buttons, previous.hat);
+    if (pressed == 0) return;
+
+    if (pushEdge(exact ? (pressed | EDGE_EXACT) : pressed, source)) {
+        edgeEvents.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        edgeDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void applyPressedEdges(SwitchReport &report, uint32_t now, uint32_t sources) {
+    // 入力元が切り替わったら（タイムライン再生の開始・終了）前の入力元の押下を持ち越さない
+    if (sources != activeSources) {
+        for (int i = 0; i < INPUT_EDGE_BIT_COUNT; i++) pendingPresses[i] = 0;
+        pending = 0;
+        pendingExact = 0;
+        holding = 0;
+        holdingExact = 0;
+        activeSources = sources;
+    }
+
+    // キューの押下をビットごとの未反映数に加算（レポートに使わない入力元は破棄）
+    uint32_t pressed;
+    uint8_t source;
+    while (popEdge(pressed, source)) {
+        if (!(sources & INPUT_SOURCE_BIT(source))) {
+            edgeIgnored.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // 同じビットに保持時間の異なる押下が残っている場合は後のものに合わせる
+        uint32_t bits = pressed & ~EDGE_EXACT;
+        if (pressed & EDGE_EXACT) pendingExact |= bits;
+        else pendingExact &= ~bits;
+        for (int i = 0; i < INPUT_EDGE_BIT_COUNT; i++) {
+            if (!(pressed & (1u << i))) continue;
+            if (pendingPresses[i] < UINT8_MAX) {
+                pendingPresses[i]++;
+                pending |= 1u << i;
+            } else {
+                edgeCoalesced.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    if ((holding | pending) == 0) return;
+
+    uint32_t level = edgeBits(report.buttons, report.hat);
+    uint32_t forced = 0;
+    for (int i = 0; i < INPUT_EDGE_BIT_COUNT; i++) {
+        uint32_t bit = 1u << i;
+        if (holding & bit) {
+            // 最小保持時間内は押下を維持（最小保持時間なしの押下は出したレポートのみ）
+            if (!(holdingExact & bit) && now - holdStart[i] < INPUT_EDGE_MIN_HOLD_MS) {
+                forced |= bit;
+                continue;
+            }
+            holding &= ~bit;
+            // 次の押下はこのレポートで一度離してから。入力が押されたままなら区別できないためまとめる
+            if ((pending & bit) && (level & bit)) {
+                edgeCoalesced.fetch_add(pendingPresses[i], std::memory_order_relaxed);
+                pendingPresses[i] = 0;
+                pending &= ~bit;
+                pendingExact &= ~bit;
+            }
+            continue;
+        }
+        if (!(pending & bit)) continue;
+
+        // 未反映の押下を1つレポートに出す
+        if (pendingExact & bit) holdingExact |= bit;
+        else holdingExact &= ~bit;
+        if (--pendingPresses[i] == 0) {
+            pending &= ~bit;
+            pendingExact &= ~bit;
+        }
+        if (!(level & bit)) edgeStretched.fetch_add(1, std::memory_order_relaxed);
+        edgePresses.fetch_add(1, std::memory_order_relaxed);
+        holdStart[i] = now;
+        holding |= bit;
+        forced |= bit;
+    }
+
+    report.buttons |= (uint16_t)forced;
+    report.hat = dpadToHat(hatToDpad(report.hat) | (uint8_t)(forced >> INPUT_EDGE_DPAD_SHIFT));
+}
+
+InputEdgeStats getInputEdgeStats() {
+    InputEdgeStats stats;
+    stats.events = edgeEvents.load(std::memory_order_relaxed);
+    stats.presses = edgePresses.load(std::memory_order_relaxed);
+    stats.stretched = edgeStretched.load(std::memory_order_relaxed);
+    stats.coalesced = edgeCoalesced.load(std::memory_order_relaxed);
+    stats.dropped = edgeDropped.load(std::memory_order_relaxed);
+    stats.ignored = edgeIgnored.load(std::memory_order_relaxed);
+    return stats;
+}
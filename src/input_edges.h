@@ -0,0 +1,41 @@
+#ifndef INPUT_EDGES_H
+#define INPUT_EDGES_H
+
+#include <stdint.h>
+#include "controller_state.h"
+#include "switch_report.h"
+
+// 押下エッジのビット（0〜15: SWITCH_BTN_*、16〜19: 十字キーのDPAD_*）
+#define INPUT_EDGE_DPAD_SHIFT 16
+#define INPUT_EDGE_BIT_COUNT 20
+
+// 押下エッジの統計
+struct InputEdgeStats {
+    uint32_t events = 0;       // キューに積んだイベント数（1回の公開で押されたボタンをまとめて1件）
+    uint32_t presses = 0;      // レポートに反映した押下数
+    uint32_t stretched = 0;    // 入力は解放済みだったがレポートで押下を保持した数（取りこぼしを防いだタップ）
+    uint32_t coalesced = 0;    // 前の押下と区別できず1回にまとめた押下数
+    uint32_t dropped = 0;      // キューが満杯で破棄したイベント数
+    uint32_t ignored = 0;      // レポートに使われていない入力元のため破棄したイベント数（タイムライン再生中のWeb入力等）
+};
+
+/**
+ * 前回公開した状態から新たに押されたボタン・十字キーを入力元（InputSource）付きでキューに積む（入力元の公開時に呼ぶ、ロックなし）
+ * exact: 最小保持時間なしで1レポートだけ押下を保持（レポート周期に合わせて公開した入力用）
+ */
+void pushPressedEdges(const ControllerState &previous, const ControllerState &next, uint8_t source,
+                      bool exact = false);
+
+/**
+ * キューの押下を取り出してレポートに反映（各押下を最低1レポート・INPUT_EDGE_MIN_HOLD_MS保持、exactの押下は1レポート）
+ * sources: このレポートに使う入力元（INPUT_SOURCE_BITの組み合わせ）。それ以外の押下は破棄し、
+ * 前回から変わった場合は保持中・未反映の押下も破棄する。レポート送信側のみ呼ぶ
+ */
+void applyPressedEdges(SwitchReport &report, uint32_t now, uint32_t sources);
+
+/**
+ * 押下エッジの統計を取得
+ */
+InputEdgeStats getInputEdgeStats();
+
+#endif // INPUT_EDGES_H
@@ -0,0 +1,130 @@
+#include "input_frame.h"
+#include "stick_jitter.h"
+#include "env.h"
+#include <string.h>
+
+static int16_t clampStick(int16_t value) {
+    if (value < -100) return -100;
+    if (value > 100) return 100;
+    return value;
+}
+
+// 受信フレームの状態をコントローラー状態に変換
+static void convertFrameState(const UdpFrameState &frame, ControllerState &state) {
+    state.buttons = frame.buttons;
+    state.hat = frame.hat <= SWITCH_HAT_NEUTRAL ? frame.hat : SWITCH_HAT_NEUTRAL;
+    state.lstick_x = clampStick(frame.lstick_x);
+    state.lstick_y = clampStick(frame.lstick_y);
+    state.rstick_x = clampStick(frame.rstick_x);
+    state.rstick_y = clampStick(frame.rstick_y);
+}
+
+static void applyFrameState(const ControllerState &converted, uint32_t now) {
+    ControllerState previous;
+    webInput.read(previous);
+
+    ControllerState state = converted;
+    trackLatestInput(previous, state, now);
+
+    webInput.publish(state);
+}
+
+// 先頭（最新）の状態を取り出す
+static void readLatestState(const uint8_t *data, ControllerState &state) {
+    UdpFrameState frame;
+    memcpy(&frame, data + sizeof(UdpFrameHeader), sizeof(frame));
+    convertFrameState(frame, state);
+}
+
+FrameSequence &findFrameSender(FrameSender *senders, size_t count, uint32_t address, uint16_t port) {
+    size_t oldest = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (senders[i].sequence.valid && senders[i].address == address && senders[i].port == port) {
+            return senders[i].sequence;
+        }
+        if (!senders[i].sequence.valid) {
+            oldest = i;
+        } else if (senders[oldest].sequence.valid &&
+                   (int32_t)(senders[i].sequence.last_ms - senders[oldest].sequence.last_ms) < 0) {
+            oldest = i;
+        }
+    }
+
+    // 再起動したクライアントは送信元ポートが変わるため新しい送信元として扱う
+    senders[oldest].address = address;
+    senders[oldest].port = port;
+    senders[oldest].sequence = FrameSequence();
+    return senders[oldest].sequence;
+}
+
+bool applyInputFrame(FrameReceiver &receiver, const uint8_t *data, int length, uint32_t now) {
+    return applyInputFrame(receiver, receiver.sequence, data, length, now);
+}
+
+bool applyInputFrame(FrameReceiver &receiver, FrameSequence &sequence, const uint8_t *data, int length, uint32_t now) {
+    UdpInputStats &stats = receiver.stats;
+    stats.packets++;
+
+    if (length < (int)sizeof(UdpFrameHeader)) {
+        stats.invalid++;
+        return false;
+    }
+
+    UdpFrameHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != UDP_FRAME_MAGIC || header.version != UDP_FRAME_VERSION ||
+        header.count == 0 || header.count > UDP_MAX_STATES ||
+        length < (int)(sizeof(UdpFrameHeader) + sizeof(UdpFrameState) * header.count)) {
+        stats.invalid++;
+        return false;
+    }
+
+    // しばらく受信がなければ送信し直し（同じポートでのクライアント再起動）とみなす
+    if (sequence.valid && now - sequence.last_ms >= UDP_SEQ_IDLE_MS) {
+        sequence.valid = false;
+    }
+    if (!sequence.valid) stats.sessions++;
+    sequence.last_ms = now;
+
+    // シーケンス番号の比較（ラップアラウンド考慮）
+    // 大きく巻き戻った場合はクライアント再起動とみなして受け入れる
+    int32_t diff = (int32_t)(header.seq - sequence.last_seq);
+    if (sequence.valid && diff <= 0 && diff > -UDP_SEQ_RESET_WINDOW) {
+        stats.stale++;
+        // 順序違いでもスティックはジッターバッファで時刻順に並べ替えて使う
+        if (header.client_time_ms != 0) {
+            ControllerState state;
+            readLatestState(data, state);
+            pushStickSample(header.seq, header.client_time_ms, state, now);
+        }
+        return false;
+    }
+
+    // 未反映の状態数（再送分のうち前回以降のもの。初回/再起動時は最新のみ）
+    int pending = 1;
+    if (sequence.valid && diff > 0) {
+        pending = diff < header.count ? diff : header.count;
+    }
+
+    // 古い順に反映（状態は新しい順に並んでいる）
+    for (int i = pending - 1; i >= 0; i--) {
+        UdpFrameState frame;
+        memcpy(&frame, data + sizeof(UdpFrameHeader) + sizeof(UdpFrameState) * i, sizeof(frame));
+        ControllerState state;
+        convertFrameState(frame, state);
+        applyFrameState(state, now);
+        // 送信時刻が分かる最新の状態のみスティックのジッターバッファへ（再送分の抜けは補間）
+        if (i == 0 && header.client_time_ms != 0) {
+            pushStickSample(header.seq, header.client_time_ms, state, now);
+        }
+        stats.applied++;
+        if (i > 0) stats.recovered++;
+    }
+
+    sequence.valid = true;
+    sequence.last_seq = header.seq;
+    stats.last_seq = header.seq;
+    stats.last_client_time = header.client_time_ms;
+    return true;
+}
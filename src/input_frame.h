@@ -0,0 +1,78 @@
+#ifndef INPUT_FRAME_H
+#define INPUT_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "controller_state.h"
+
+// バイナリ入力フレーム（UDP/WebSocket共通、リトルエンディアン）
+// [ヘッダー12byte][状態12byte × count]（状態は新しい順、先頭がseqの状態）
+#define UDP_FRAME_MAGIC 0x5753      // "SW"
+#define UDP_FRAME_VERSION 1
+
+struct __attribute__((packed)) UdpFrameHeader {
+    uint16_t magic;            // UDP_FRAME_MAGIC
+    uint8_t version;           // UDP_FRAME_VERSION
+    uint8_t count;             // 含まれる状態数（1 + 再送分）
+    uint32_t seq;              // 先頭（最新）状態のシーケンス番号
+    uint32_t client_time_ms;   // クライアント送信時刻（任意、0=なし）
+};
+
+struct __attribute__((packed)) UdpFrameState {
+    uint16_t buttons;          // SWITCH_BTN_* のビットマスク
+    uint8_t hat;               // SWITCH_HAT_*
+    uint8_t reserved;
+    int16_t lstick_x;          // -100 to 100
+    int16_t lstick_y;          // -100 to 100（上が正）
+    int16_t rstick_x;
+    int16_t rstick_y;
+};
+
+// バイナリフレーム受信統計
+struct UdpInputStats {
+    uint32_t packets = 0;        // 受信パケット数
+    uint32_t applied = 0;        // 反映した状態数
+    uint32_t recovered = 0;      // 再送分から復元した状態数
+    uint32_t stale = 0;          // 古い/順序違いで破棄したパケット数
+    uint32_t invalid = 0;        // 形式不正で破棄したパケット数
+    uint32_t sessions = 0;       // シーケンスを取り直した数（新しい送信元、UDP_SEQ_IDLE_MS以上の無通信後）
+    uint32_t last_seq = 0;       // 最後に反映したシーケンス番号
+    uint32_t last_client_time = 0; // 最後に反映したクライアント時刻
+};
+
+// 送信元1つ分のシーケンス
+struct FrameSequence {
+    bool valid = false;          // last_seqが有効（falseなら次のフレームを新しい送信の始まりとして受け入れる）
+    uint32_t last_seq = 0;       // 最後に反映したシーケンス番号
+    uint32_t last_ms = 0;        // 最後に受信した時刻
+};
+
+// UDPの送信元（IPv4アドレス・ポート）ごとのシーケンス
+struct FrameSender {
+    uint32_t address = 0;
+    uint16_t port = 0;
+    FrameSequence sequence;
+};
+
+// バイナリフレームの受信側状態（統計と、WebSocketでは接続ごとのシーケンス）
+struct FrameReceiver {
+    FrameSequence sequence;
+    UdpInputStats stats;
+};
+
+/**
+ * 送信元のシーケンスを検索（なければ最も長く受信のない枠を割り当てて初期化）
+ */
+FrameSequence &findFrameSender(FrameSender *senders, size_t count, uint32_t address, uint16_t port);
+
+/**
+ * バイナリ入力フレームを検証してwebInputへ反映（送信元のシーケンスで順序を判定、反映した場合true）
+ */
+bool applyInputFrame(FrameReceiver &receiver, FrameSequence &sequence, const uint8_t *data, int length, uint32_t now);
+
+/**
+ * バイナリ入力フレームを検証してwebInputへ反映（送信元が1つの場合、receiver.sequenceを使用）
+ */
+bool applyInputFrame(FrameReceiver &receiver, const uint8_t *data, int length, uint32_t now);
+
+#endif // INPUT_FRAME_H
@@ -0,0 +1,91 @@
+#include "input_ingest.h"
+#include "input_clock.h"
+#include "hal.h"
+#include <stdio.h>
+
+// 固定レスポンス
+static const char REPLY_NO_BODY[] = "{\"error\":\"No JSON body\"}";
+static const char REPLY_INVALID[] = "{\"error\":\"Invalid JSON\"}";
+static const char REPLY_TOO_LARGE[] = "{\"error\":\"JSON too large\"}";
+static const char REPLY_BAD_TIME[] = "{\"error\":\"Invalid at_us\"}";
+static const char REPLY_SCHEDULE_FULL[] = "{\"error\":\"Schedule full\"}";
+
+static void (*inputPublishHook)() = nullptr;
+
+void setInputPublishHook(void (*hook)()) {
+    inputPublishHook = hook;
+}
+
+JsonIngestResult ingestControllerJson(const char *body, size_t length, ControllerState &applied, uint32_t *seq,
+                                      ReportCycle *cycle) {
+    // 解析用の固定領域も共有のため、解析から公開までを排他
+    lockWebInput();
+
+    // JSONに含まれるフィールドのみを差分として解析
+    ControllerState delta;
+    ControllerStateMask mask;
+    int64_t at_us = 0;
+    ReportCycle target;
+    uint32_t now = halMillis();
+    JsonIngestResult result = parseControllerJson(body, length, delta, now, seq, &at_us, &mask);
+
+    // 現在の状態をベースに、含まれるフィールドのみ上書き
+    webInput.read(applied);
+    if (result == JSON_INGEST_OK) mergeControllerState(applied, delta, mask, now);
+
+    if (result == JSON_INGEST_OK && at_us != 0) {
+        // 時刻指定: 指定時刻に最も近い周期でレポート送信側がその時点の状態へ反映
+        switch (queueScheduledInput(delta, mask, at_us, target)) {
+            case SCHEDULE_OK: break;
+            case SCHEDULE_TOO_FAR: result = JSON_INGEST_BAD_TIME; break;
+            default: result = JSON_INGEST_SCHEDULE_FULL; break;
+        }
+    } else if (result == JSON_INGEST_OK) {
+        // 1フレーム分まとめて公開（次の周期で反映）
+        webInput.publish(applied);
+        if (inputPublishHook != nullptr) inputPublishHook();
+        target = predictReportCycle(halMicros());
+    }
+    unlockWebInput();
+
+    if (cycle != nullptr) *cycle = target;
+    return result;
+}
+
+int processControllerBody(const char *body, size_t length, char *buffer, size_t size,
+                          const char *&reply, size_t &replyLength) {
+    if (length == 0) {
+        reply = REPLY_NO_BODY;
+        replyLength = sizeof(REPLY_NO_BODY) - 1;
+        return 400;
+    }
+
+    ControllerState applied;
+    ReportCycle cycle;
+    switch (ingestControllerJson(body, length, applied, nullptr, &cycle)) {
+        case JSON_INGEST_OK: {
+            // 反映するレポート周期の番号と予定時刻（デバイス時刻）
+            int n = snprintf(buffer, size, "{\"status\":\"OK\",\"frame\":%lu,\"apply_us\":%lld}",
+                             (unsigned long)cycle.frame, (long long)cycle.time_us);
+            reply = buffer;
+            replyLength = n > 0 && (size_t)n < size ? n : 0;
+            return 200;
+        }
+        case JSON_INGEST_TOO_LARGE:
+            reply = REPLY_TOO_LARGE;
+            replyLength = sizeof(REPLY_TOO_LARGE) - 1;
+            return 413;
+        case JSON_INGEST_BAD_TIME:
+            reply = REPLY_BAD_TIME;
+            replyLength = sizeof(REPLY_BAD_TIME) - 1;
+            return 400;
+        case JSON_INGEST_SCHEDULE_FULL:
+            reply = REPLY_SCHEDULE_FULL;
+            replyLength = sizeof(REPLY_SCHEDULE_FULL) - 1;
+            return 503;
+        default:
+            reply = REPLY_INVALID;
+            replyLength = sizeof(REPLY_INVALID) - 1;
+            return 400;
+    }
+}
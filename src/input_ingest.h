@@ -0,0 +1,32 @@
+#ifndef INPUT_INGEST_H
+#define INPUT_INGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "controller_json.h"
+#include "report_pipeline.h"
+
+// POST /controllerの応答本文の最大長（frame・apply_us入り）
+#define CONTROLLER_REPLY_SIZE 96
+
+/**
+ * 入力を公開した直後に呼ぶ関数を設定（計測用、nullptrで解除）
+ */
+void setInputPublishHook(void (*hook)());
+
+/**
+ * コントローラー入力JSONを解析して公開（HTTP/WebSocket共通、appliedに反映後の状態）
+ * "at_us"があればJSONに含まれるフィールドのみをその時刻に反映するようキューへ追加（appliedは現時点で反映した場合の状態）
+ * cycleに反映予定のレポート周期を返す
+ */
+JsonIngestResult ingestControllerJson(const char *body, size_t length, ControllerState &applied, uint32_t *seq,
+                                      ReportCycle *cycle = nullptr);
+
+/**
+ * POST /controllerの本文を処理して応答コードと応答本文を返す（WebServer/非同期HTTP/native共通）
+ * 応答本文は固定文字列、またはbufferに書き出した反映予定の周期
+ */
+int processControllerBody(const char *body, size_t length, char *buffer, size_t size,
+                          const char *&reply, size_t &replyLength);
+
+#endif // INPUT_INGEST_H
@@ -0,0 +1,177 @@
+#include "input_scheduler.h"
+#include "env.h"
+#include <esp_timer.h>
+
+// タイムラインのキュー（リングバッファ）
+static TimelineFrame timelineQueue[TIMELINE_MAX_FRAMES];
+static size_t queueHead = 0;      // 次に再生するフレーム位置
+static size_t queueCount = 0;     // キュー内のフレーム数
+
+// 再生状態
+static TimelineStatus status;
+static int64_t frameDeadline = 0;           // 再生中フレームの終了時刻（us）
+static std::atomic<bool> timelineActive{false};
+static uint16_t timelineIdCounter = 0;
+static esp_timer_handle_t timelineTimer = nullptr;
+static portMUX_TYPE timelineMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 再生の世代（再生開始・中断ごとに進める）と設定中のタイマー
+// 中断・再開の直前に発火済みだったタイマー処理が、新しい再生のフレームを進めないよう照合する
+static uint32_t playGeneration = 0;
+static uint32_t timerGeneration = 0;        // タイマーを設定した再生の世代
+static int64_t timerExpiry = 0;             // タイマーの満了時刻（us、esp_timerはこれより前に発火しない）
+
+// キュー先頭のフレームを取り出して再生開始（timelineMux保持中に呼ぶ）
+static TimelineFrame popFrameLocked() {
+    TimelineFrame frame = timelineQueue[queueHead];
+    queueHead = (queueHead + 1) % TIMELINE_MAX_FRAMES;
+    queueCount--;
+
+    status.current_id = frame.sequence_id;
+    status.queued_frames = queueCount;
+    frameDeadline += (int64_t)frame.duration_ms * 1000;
+    return frame;
+}
+
+// フレームの状態を公開し、終了時刻にタイマーを設定（timelineMux保持中に呼ぶ）
+// 中断と入れ替わらないよう、公開・タイマー設定は再生中かつ同じ世代の場合のみ
+static void startFrameLocked(const TimelineFrame &frame, int64_t deadline, uint32_t generation) {
+    if (!status.playing || generation != playGeneration) return;
+
+    timelineInput.publish(frame.state);
+
+    int64_t now = esp_timer_get_time();
+    int64_t wait = deadline > now ? deadline - now : 0;
+    // 設定中のタイマーがあると開始できないため先に止める（未設定ならエラーを返すだけ）
+    esp_timer_stop(timelineTimer);
+    if (esp_timer_start_once(timelineTimer, wait) != ESP_OK) {
+        // 次のフレームへ進めないため再生を終了
+        status.playing = false;
+        status.aborted++;
+        queueCount = 0;
+        status.queued_frames = 0;
+        timelineActive.store(false, std::memory_order_release);
+        return;
+    }
+    timerGeneration = generation;
+    timerExpiry = now + wait;
+}
+
+// フレーム終了時のタイマー処理（esp_timerタスクで実行）
+static void onTimelineTimer(void *param) {
+    int64_t now = esp_timer_get_time();
+    bool hasNext = false;
+    TimelineFrame next;
+    int64_t deadline = 0;
+
+    portENTER_CRITICAL(&timelineMux);
+    if (!status.playing || timerGeneration != playGeneration || now < timerExpiry) {
+        // 中断済み、または中断・再開前に発火していた古いタイマー
+        portEXIT_CRITICAL(&timelineMux);
+        return;
+    }
+
+    uint32_t late = now > frameDeadline ? (uint32_t)(now - frameDeadline) : 0;
+    if (late > status.max_late_us) status.max_late_us = late;
+    status.played_frames++;
+
+    uint16_t finishedId = status.current_id;
+    if (queueCount > 0) {
+        next = popFrameLocked();
+        deadline = frameDeadline;
+        hasNext = true;
+    }
+
+    // シーケンスの切り替わり・キューが空になったら完了
+    if (!hasNext || next.sequence_id != finishedId) {
+        status.completed++;
+        status.last_completed_id = finishedId;
+    }
+    if (hasNext) {
+        startFrameLocked(next, deadline, playGeneration);
+    } else {
+        status.playing = false;
+        timelineActive.store(false, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&timelineMux);
+}
+
+void initInputScheduler() {
+    esp_timer_create_args_t args = {};
+    args.callback = onTimelineTimer;
+    args.name = "timeline";
+    esp_timer_create(&args, &timelineTimer);
+}
+
+bool queueTimeline(const TimelineFrame *frames, size_t count) {
+    if (timelineTimer == nullptr || count == 0) return false;
+
+    portENTER_CRITICAL(&timelineMux);
+    if (count > TIMELINE_MAX_FRAMES - queueCount) {
+        portEXIT_CRITICAL(&timelineMux);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        timelineQueue[(queueHead + queueCount) % TIMELINE_MAX_FRAMES] = frames[i];
+        queueCount++;
+    }
+    status.last_queued_id = frames[count - 1].sequence_id;
+    status.queued_frames = queueCount;
+
+    // 停止中なら先頭フレームから再生開始
+    if (!status.playing) {
+        status.playing = true;
+        playGeneration++;
+        timelineActive.store(true, std::memory_order_release);
+        frameDeadline = esp_timer_get_time();
+        TimelineFrame first = popFrameLocked();
+        startFrameLocked(first, frameDeadline, playGeneration);
+    }
+    portEXIT_CRITICAL(&timelineMux);
+    return true;
+}
+
+uint16_t nextTimelineId() {
+    timelineIdCounter++;
+    if (timelineIdCounter == 0) timelineIdCounter = 1;
+    return timelineIdCounter;
+}
+
+void abortTimeline() {
+    portENTER_CRITICAL(&timelineMux);
+    // 発火済みのタイマー処理は世代が変わったため何もしない
+    playGeneration++;
+    if (timelineTimer != nullptr) {
+        esp_timer_stop(timelineTimer);
+    }
+    if (status.playing) {
+        status.aborted++;
+    }
+    status.playing = false;
+    queueHead = 0;
+    queueCount = 0;
+    status.queued_frames = 0;
+    timelineActive.store(false, std::memory_order_release);
+    // 中断後はニュートラルに戻す（次の再生の先頭フレームを上書きしないようロック内で）
+    timelineInput.publish(ControllerState());
+    portEXIT_CRITICAL(&timelineMux);
+}
+
+bool isTimelineActive() {
+    return timelineActive.load(std::memory_order_acquire);
+}
+
+TimelineStatus getTimelineStatus() {
+    portENTER_CRITICAL(&timelineMux);
+    TimelineStatus copy = status;
+    portEXIT_CRITICAL(&timelineMux);
+    return copy;
+}
+
+size_t timelineFreeFrames() {
+    portENTER_CRITICAL(&timelineMux);
+    size_t free = TIMELINE_MAX_FRAMES - queueCount;
+    portEXIT_CRITICAL(&timelineMux);
+    return free;
+}
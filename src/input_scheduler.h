@@ -0,0 +1,61 @@
+#ifndef INPUT_SCHEDULER_H
+#define INPUT_SCHEDULER_H
+
+#include "types.h"
+
+// タイムライン（時間指定の入力シーケンス）の1フレーム
+struct TimelineFrame {
+    ControllerState state;     // このフレームの間保持する状態
+    uint32_t duration_ms;      // 保持時間（ms）
+    uint16_t sequence_id;      // 所属するシーケンスID
+};
+
+// タイムライン再生状態
+struct TimelineStatus {
+    bool playing = false;          // 再生中
+    uint16_t current_id = 0;       // 再生中のシーケンスID
+    uint16_t last_queued_id = 0;   // 最後に登録したシーケンスID
+    uint16_t last_completed_id = 0;// 最後に完了したシーケンスID
+    uint32_t queued_frames = 0;    // キュー内の未再生フレーム数
+    uint32_t played_frames = 0;    // 再生済みフレーム数（累計）
+    uint32_t completed = 0;        // 完了したシーケンス数（累計）
+    uint32_t aborted = 0;          // 中断したシーケンス数（累計）
+    uint32_t max_late_us = 0;      // フレーム切り替えの最大遅れ（us）
+};
+
+/**
+ * タイムライン再生初期化（再生用タイマー作成）
+ */
+void initInputScheduler();
+
+/**
+ * シーケンスをキューへ追加（再生中なら続けて再生、空きが足りなければfalse）
+ */
+bool queueTimeline(const TimelineFrame *frames, size_t count);
+
+/**
+ * 新しいシーケンスIDを払い出し
+ */
+uint16_t nextTimelineId();
+
+/**
+ * 再生中・キュー内のシーケンスを全て中断
+ */
+void abortTimeline();
+
+/**
+ * タイムラインが入力を制御中かどうか
+ */
+bool isTimelineActive();
+
+/**
+ * 再生状態を取得
+ */
+TimelineStatus getTimelineStatus();
+
+/**
+ * キューの空きフレーム数
+ */
+size_t timelineFreeFrames();
+
+#endif // INPUT_SCHEDULER_H
@@ -1,330 +1,495 @@
 #include "lcd_display.h"
 #include "wifi_manager.h"
+#include "input_scheduler.h"
+#include "stick_jitter.h"
+#include "metrics.h"
 #include "env.h"
 
-// Nintendo Switch ボタン（実体）
-TouchButton btnA(240, 120, 70, 50, GREEN, 0x00AA00, "A");
-TouchButton btnB(240, 180, 70, 50, RED, 0xAA0000, "B");
-TouchButton btnX(160, 120, 70, 50, BLUE, 0x0000AA, "X");
-TouchButton btnY(160, 180, 70, 50, YELLOW, 0xAAAA00, "Y");
-
-// 左スティック（実体）
-TouchButton lstickUp(60, 100, 50, 40, 0x00CED1, 0x008B8D, "↑");
-TouchButton lstickDown(60, 180, 50, 40, 0x00CED1, 0x008B8D, "↓");
-TouchButton lstickLeft(10, 140, 40, 50, 0x00CED1, 0x008B8D, "←");
-TouchButton lstickRight(110, 140, 40, 50, 0x00CED1, 0x008B8D, "→");
-
-// 追加ボタン（実体）
-TouchButton btnPlus(280, 60, 35, 25, 0x9C27B0, 0x6A1B9A, "+");
-TouchButton btnMinus(5, 60, 35, 25, 0x9C27B0, 0x6A1B9A, "-");
-TouchButton btnHome(280, 30, 35, 25, 0x607D8B, 0x455A64, "H");
+// タッチボタン（実体）
+TouchButton touchButtons[TOUCH_BUTTON_COUNT];
 
 // 表示状態管理（実体）
 unsigned long lastDisplayUpdate = 0;
-String connection_status = "Nintendo Switch初期化中...";
+const char *connection_status = "Nintendo Switch初期化中...";
 bool switch_connected = false;
-int button_press_count = 0;
 
-void drawButton(TouchButton &btn) {
-    // タッチ入力またはWeb入力で押下状態を判定
-    bool isPressed = btn.current || btn.web_input;
-    uint32_t color = isPressed ? btn.pressed_color : btn.color;
+// 描画中の表示内容（描画開始時に1回だけ取得したスナップショット）
+static DisplaySnapshot shown;
+
+// loop()から表示タスクへ渡すスナップショット（未描画のものは新しいもので上書き）
+static DisplaySnapshot loopSnapshot;
+static DisplaySnapshot postedSnapshot;
+static bool snapshotPending = false;
+static portMUX_TYPE displayMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t displayTaskHandle = nullptr;
+
+// オフスクリーン描画先（確保できない場合は画面へ直接描画）
+static M5Canvas canvas(&M5.Display);
+static bool canvasReady = false;
+static bool canvasDma = false;        // 内部RAMに確保できた場合はDMAで転送
+static lgfx::LovyanGFX *gfx = &M5.Display;
+
+// 画面上の矩形領域
+struct DisplayRegion {
+    int16_t x, y, w, h;
+};
+
+// 前回描画した内容（変化した領域のみ再描画・転送）
+struct DrawnState {
+    bool valid = false;              // falseなら全体を再描画
+    bool wifi_connected = false;
+    uint8_t wifi_state = WIFI_STATE_IDLE;
+    char ip[16] = "";
+    uint8_t active_input = INPUT_NONE;
+    int16_t stick_x = 0;             // 表示中スティックの位置
+    int16_t stick_y = 0;
+    char status[48] = "";            // connection_status（タッチモード）
+    bool switch_connected = false;
+    int press_count = 0;
+    uint32_t button_bits = 0;        // タッチモードのボタン表示状態（2bit/ボタン）
+};
+static DrawnState drawn;
+
+// 画面転送量（displayMuxで保護）
+static DisplayPushStats pushStats;
+static uint32_t pushWindowStart = 0;
+static uint32_t pushWindowBytes = 0;
+
+// 描画中フレームの転送量（フレーム終了時にpushStatsへ加算）
+static uint32_t frameBytes = 0;
+static uint32_t framePushes = 0;
+
+// 領域を消去（描画先上）
+static void clearRegion(const DisplayRegion &r) {
+    gfx->fillRect(r.x, r.y, r.w, r.h, BLACK);
+}
+
+// 描画済みの領域を画面へ転送
+static void pushRegion(const DisplayRegion &r) {
+    if (canvasReady) {
+        // クリップ範囲内の画素のみ転送される
+        M5.Display.setClipRect(r.x, r.y, r.w, r.h);
+        if (canvasDma) {
+            // 転送完了を待たずに戻る（次のフレームの描画前にwaitDMA()）
+            M5.Display.pushImageDMA(0, 0, canvas.width(), canvas.height(),
+                                    (const lgfx::swap565_t *)canvas.getBuffer());
+        } else {
+            canvas.pushSprite(0, 0);
+        }
+        M5.Display.clearClipRect();
+    }
+    frameBytes += (uint32_t)r.w * r.h * 2;
+    framePushes++;
+}
+
+// 表示中の最新入力（非アクティブならINPUT_NONE）
+static uint8_t activeInputId() {
+    return isInputActive(shown.input, shown.input.last_input) ? shown.input.last_input : INPUT_NONE;
+}
+
+// 表示中スティックの位置（スティック以外は0）
+static void activeStickPosition(uint8_t input, int16_t &x, int16_t &y) {
+    x = y = 0;
+    if (input == INPUT_STICK_L) {
+        x = shown.input.lstick_x;
+        y = shown.input.lstick_y;
+    } else if (input == INPUT_STICK_R) {
+        x = shown.input.rstick_x;
+        y = shown.input.rstick_y;
+    }
+}
+
+// ヘッダー（WiFi状態）が変化したか
+static bool headerChanged() {
+    return !drawn.valid || drawn.wifi_connected != shown.wifi_connected ||
+           drawn.wifi_state != shown.wifi_state || strcmp(drawn.ip, shown.ip) != 0;
+}
+
+static void rememberHeader() {
+    drawn.wifi_connected = shown.wifi_connected;
+    drawn.wifi_state = shown.wifi_state;
+    memcpy(drawn.ip, shown.ip, sizeof(drawn.ip));
+}
+
+// 中央インジケーター（入力・スティック位置）が変化したか
+static bool indicatorChanged(uint8_t input, int16_t stickX, int16_t stickY) {
+    return !drawn.valid || drawn.active_input != input || drawn.stick_x != stickX || drawn.stick_y != stickY;
+}
+
+static void rememberIndicator(uint8_t input, int16_t stickX, int16_t stickY) {
+    drawn.active_input = input;
+    drawn.stick_x = stickX;
+    drawn.stick_y = stickY;
+}
+
+void drawButton(const ButtonDescriptor &button, uint8_t state) {
+    const TouchRect &rect = button.touch;
+    
+    // タッチ入力またはWeb入力で押下状態を判定（bit0=押下、bit1=Web入力）
+    bool isPressed = state & 1;
+    bool isWebInput = state & 2;
+    uint32_t color = isPressed ? button.pressed_color : button.color;
     
     // ボタン背景
-    M5.Display.fillRoundRect(btn.x, btn.y, btn.w, btn.h, 5, color);
+    gfx->fillRoundRect(rect.x, rect.y, rect.w, rect.h, 5, color);
     
     // ボタン枠（Web入力時は異なる色で表示）
-    uint32_t border_color = btn.web_input ? CYAN : WHITE;
-    M5.Display.drawRoundRect(btn.x, btn.y, btn.w, btn.h, 5, border_color);
+    uint32_t border_color = isWebInput ? CYAN : WHITE;
+    gfx->drawRoundRect(rect.x, rect.y, rect.w, rect.h, 5, border_color);
     
     // ボタンラベル
-    M5.Display.setTextColor(WHITE);
-    M5.Display.setTextSize(2);
-    int text_x = btn.x + (btn.w - M5.Display.textWidth(btn.label)) / 2;
-    int text_y = btn.y + (btn.h - 16) / 2;
-    M5.Display.setCursor(text_x, text_y);
-    M5.Display.print(btn.label);
+    gfx->setTextColor(WHITE);
+    gfx->setTextSize(2);
+    int text_x = rect.x + (rect.w - gfx->textWidth(button.label)) / 2;
+    int text_y = rect.y + (rect.h - 16) / 2;
+    gfx->setCursor(text_x, text_y);
+    gfx->print(button.label);
     
     // Web入力インジケーター
-    if (btn.web_input) {
-        M5.Display.fillCircle(btn.x + btn.w - 8, btn.y + 8, 3, CYAN);
+    if (isWebInput) {
+        gfx->fillCircle(rect.x + rect.w - 8, rect.y + 8, 3, CYAN);
     }
 }
 
+// ボタンの表示状態（bit0=押下、bit1=Web入力）
+static uint32_t buttonDrawBits(const TouchButton &btn) {
+    return ((btn.current || btn.web_input) ? 1 : 0) | (btn.web_input ? 2 : 0);
+}
+
 void updateDisplayTouchMode() {
-    M5.Display.clear(BLACK);
-    
-    // ヘッダー
-    M5.Display.setCursor(10, 10);
-    M5.Display.setTextColor(WHITE);
-    M5.Display.setTextSize(2);
-    M5.Display.println("Nintendo Switch Controller");
-    
-    // 状態表示
-    M5.Display.setCursor(10, 40);
-    M5.Display.setTextSize(1);
-    M5.Display.println("Status: " + connection_status);
+    const DisplayRegion status = {0, 38, LCD_WIDTH, 44};
+    const DisplayRegion active = {0, 248, LCD_WIDTH, 12};
     
-    // 接続状態
-    M5.Display.setCursor(10, 55);
-    if (switch_connected) {
-        M5.Display.setTextColor(GREEN);
-        M5.Display.println("★ SWITCH CONNECTED ★");
-    } else {
-        M5.Display.setTextColor(ORANGE);
-        M5.Display.println("USB READY - Connect to Switch");
+    // ヘッダー・操作説明は変化しないため最初の1回のみ描画（画面全体の消去はrenderDisplay()）
+    if (!drawn.valid) {
+        const DisplayRegion title = {0, 0, LCD_WIDTH, 30};
+        const DisplayRegion help = {0, 265, LCD_WIDTH, 30};
+        
+        // ヘッダー
+        gfx->setCursor(10, 10);
+        gfx->setTextColor(WHITE);
+        gfx->setTextSize(2);
+        gfx->println("Nintendo Switch Controller");
+        
+        // 操作説明
+        gfx->setTextSize(1);
+        gfx->setCursor(10, 270);
+        gfx->println("Touch: L-Stick/L/ZL(Left) + ABXY/R/ZR(Right) + System(Top)");
+        gfx->setCursor(10, 285);
+        gfx->println("Web: POST /controller (JSON) - Blue border = Web input");
+        pushRegion(title);
+        pushRegion(help);
     }
     
-    // WiFi状態表示
-    M5.Display.setCursor(200, 55);
-    if (wifi_connected) {
-        M5.Display.setTextColor(CYAN);
-        M5.Display.println("WiFi: " + wifi_ip);
-    } else {
-        M5.Display.setTextColor(RED);
-        M5.Display.println("WiFi: Disconnected");
+    // 状態表示・接続状態・WiFi状態・統計情報
+    if (headerChanged() || drawn.switch_connected != shown.switch_connected ||
+        drawn.press_count != shown.press_count || strcmp(drawn.status, shown.status) != 0) {
+        clearRegion(status);
+        
+        gfx->setCursor(10, 40);
+        gfx->setTextColor(WHITE);
+        gfx->setTextSize(1);
+        gfx->print("Status: ");
+        gfx->println(shown.status);
+        
+        gfx->setCursor(10, 55);
+        if (shown.switch_connected) {
+            gfx->setTextColor(GREEN);
+            gfx->println("★ SWITCH CONNECTED ★");
+        } else {
+            gfx->setTextColor(ORANGE);
+            gfx->println("USB READY - Connect to Switch");
+        }
+        
+        gfx->setCursor(200, 55);
+        if (shown.wifi_connected) {
+            gfx->setTextColor(CYAN);
+            gfx->print("WiFi: ");
+            gfx->println(shown.ip);
+        } else if (shown.wifi_state == WIFI_STATE_CONNECTING) {
+            gfx->setTextColor(YELLOW);
+            gfx->println("WiFi: Connecting...");
+        } else {
+            gfx->setTextColor(RED);
+            gfx->println("WiFi: Disconnected");
+        }
+        
+        gfx->setTextColor(WHITE);
+        gfx->setCursor(10, 70);
+        gfx->print("Button presses: ");
+        gfx->println(shown.press_count);
+        pushRegion(status);
+        
+        rememberHeader();
+        drawn.switch_connected = shown.switch_connected;
+        drawn.press_count = shown.press_count;
+        memcpy(drawn.status, shown.status, sizeof(drawn.status));
     }
     
-    // 統計情報
-    M5.Display.setTextColor(WHITE);
-    M5.Display.setCursor(10, 70);
-    M5.Display.setTextSize(1);
-    M5.Display.print("Button presses: ");
-    M5.Display.println(button_press_count);
-    
-    // メインボタン描画
-    drawButton(btnA);
-    drawButton(btnB);
-    drawButton(btnX);
-    drawButton(btnY);
-    
-    // 左スティック描画
-    drawButton(lstickUp);
-    drawButton(lstickDown);
-    drawButton(lstickLeft);
-    drawButton(lstickRight);
-    
-    // 追加ボタン描画
-    drawButton(btnPlus);
-    drawButton(btnMinus);
-    drawButton(btnHome);
+    // ボタン描画（表示状態が変わったボタンのみ）
+    for (size_t i = 0; i < TOUCH_BUTTON_COUNT; i++) {
+        const ButtonDescriptor &button = BUTTON_TABLE[i];
+        uint8_t state = (shown.button_bits >> (i * 2)) & 3;
+        if (!drawn.valid || ((drawn.button_bits >> (i * 2)) & 3) != state) {
+            const DisplayRegion tile = {button.touch.x, button.touch.y, button.touch.w, button.touch.h};
+            clearRegion(tile);
+            drawButton(button, state);
+            pushRegion(tile);
+        }
+    }
     
     // ボタン状態表示
-    M5.Display.setTextColor(WHITE);
-    M5.Display.setTextSize(1);
-    M5.Display.setCursor(10, 250);
-    String status = "Active: ";
-    if (btnA.current || btnA.web_input) status += "[A] ";
-    if (btnB.current || btnB.web_input) status += "[B] ";
-    if (btnX.current || btnX.web_input) status += "[X] ";
-    if (btnY.current || btnY.web_input) status += "[Y] ";
-    if (lstickUp.current || lstickUp.web_input) status += "[L↑] ";
-    if (lstickDown.current || lstickDown.web_input) status += "[L↓] ";
-    if (lstickLeft.current || lstickLeft.web_input) status += "[L←] ";
-    if (lstickRight.current || lstickRight.web_input) status += "[L→] ";
-    if (btnPlus.current || btnPlus.web_input) status += "[+] ";
-    if (btnMinus.current || btnMinus.web_input) status += "[-] ";
-    if (btnHome.current || btnHome.web_input) status += "[H] ";
-    M5.Display.println(status);
-    
-    // 操作説明
-    M5.Display.setCursor(10, 270);
-    M5.Display.setTextSize(1);
-    M5.Display.println("Touch: L-Stick(Left) + ABXY(Right) + System(Top)");
-    M5.Display.setCursor(10, 285);
-    M5.Display.println("Web: POST /controller (JSON) - Blue border = Web input");
+    if (!drawn.valid || shown.button_bits != drawn.button_bits) {
+        clearRegion(active);
+        gfx->setTextColor(WHITE);
+        gfx->setTextSize(1);
+        gfx->setCursor(10, 250);
+        gfx->print("Active: ");
+        for (size_t i = 0; i < TOUCH_BUTTON_COUNT; i++) {
+            if ((shown.button_bits >> (i * 2)) & 1) {
+                // 左スティック方向は"L"を付けて表示（例: [L↑]）
+                gfx->print(BUTTON_TABLE[i].kind == BUTTON_KIND_STICK_DIR ? "[L" : "[");
+                gfx->print(BUTTON_TABLE[i].label);
+                gfx->print("] ");
+            }
+        }
+        pushRegion(active);
+    }
+    drawn.button_bits = shown.button_bits;
     
     // タッチ座標表示はtouch_control.cppに移動
 }
 
 void updateDisplayAtomS3() {
-    M5.Display.clear(BLACK);
-    
     // 小型画面用のレイアウト（128x128）
-    M5.Display.setTextSize(1);
-    
-    // WiFi状態表示（上部）- 接続成功時は暗い灰色でIPアドレス、失敗時は赤で「No Wifi」
-    M5.Display.setCursor(2, 2);
-    if (wifi_connected) {
-        // 接続成功時：暗い灰色でIPアドレス表示
-        M5.Display.setTextColor(M5.Display.color565(40, 40, 40));  // より暗い灰色
-        M5.Display.print(wifi_ip);
-    } else {
-        // 接続失敗時：赤で「No Wifi」表示
-        M5.Display.setTextColor(M5.Display.color565(255, 0, 0));  // 赤色
-        M5.Display.print("No Wifi");
+    const DisplayRegion header = {0, 0, LCD_WIDTH, 10};
+    const int centerX = LCD_WIDTH / 2;
+    const int centerY = LCD_HEIGHT / 2;
+    const DisplayRegion indicator = {(int16_t)(centerX - 32), (int16_t)(centerY - 32), 64, 64};
+    
+    // WiFi状態表示（上部）- 接続成功時は暗い灰色でIPアドレス、接続中は黄色、失敗時は赤で「No Wifi」
+    if (headerChanged()) {
+        clearRegion(header);
+        gfx->setTextSize(1);
+        gfx->setCursor(2, 2);
+        if (shown.wifi_connected) {
+            // 接続成功時：暗い灰色でIPアドレス表示
+            gfx->setTextColor(gfx->color565(40, 40, 40));  // より暗い灰色
+            gfx->print(shown.ip);
+        } else if (shown.wifi_state == WIFI_STATE_CONNECTING) {
+            // 接続試行中：黄色で表示
+            gfx->setTextColor(gfx->color565(255, 255, 0));
+            gfx->print("WiFi...");
+        } else {
+            // 接続失敗時：赤で「No Wifi」表示
+            gfx->setTextColor(gfx->color565(255, 0, 0));  // 赤色
+            gfx->print("No Wifi");
+        }
+        pushRegion(header);
+        rememberHeader();
     }
     
     // Web入力状態表示（中央）- アクティブ入力のみ表示
-    String activeInput = getActiveWebInput();
-    if (activeInput != "") {
-        int centerX = LCD_WIDTH / 2;
-        int centerY = LCD_HEIGHT / 2;
-        
-        if (activeInput.startsWith("STICK_")) {
+    uint8_t input = activeInputId();
+    int16_t stickX, stickY;
+    activeStickPosition(input, stickX, stickY);
+    if (indicatorChanged(input, stickX, stickY)) {
+        clearRegion(indicator);
+        if (input == INPUT_STICK_L || input == INPUT_STICK_R) {
             // 小型スティック表示
-            drawAtomS3StickIndicator(centerX, centerY, activeInput);
-        } else {
+            drawAtomS3StickIndicator(centerX, centerY, input);
+        } else if (input != INPUT_NONE) {
             // 小型ボタン表示
-            drawAtomS3ButtonIndicator(centerX, centerY, activeInput);
+            drawAtomS3ButtonIndicator(centerX, centerY, inputName(input));
         }
+        // デフォルト時は何も表示しない（ルール仕様）
+        pushRegion(indicator);
+        rememberIndicator(input, stickX, stickY);
     }
-    // デフォルト時は何も表示しない（ルール仕様）
 }
 
-void drawAtomS3ButtonIndicator(int centerX, int centerY, String buttonName) {
+void drawAtomS3ButtonIndicator(int centerX, int centerY, const char *buttonName) {
     // 小型画面用ボタン表示（半径25）
     int radius = 25;
-    M5.Display.fillCircle(centerX, centerY, radius, WHITE);
-    M5.Display.drawCircle(centerX, centerY, radius, BLACK);
+    gfx->fillCircle(centerX, centerY, radius, WHITE);
+    gfx->drawCircle(centerX, centerY, radius, BLACK);
     
     // ボタン名を表示
-    M5.Display.setTextColor(BLACK);
-    M5.Display.setTextSize(2);
-    int textWidth = M5.Display.textWidth(buttonName);
+    gfx->setTextColor(BLACK);
+    gfx->setTextSize(2);
+    int textWidth = gfx->textWidth(buttonName);
     int textX = centerX - textWidth / 2;
     int textY = centerY - 8;
-    M5.Display.setCursor(textX, textY);
-    M5.Display.print(buttonName);
+    gfx->setCursor(textX, textY);
+    gfx->print(buttonName);
 }
 
-void drawAtomS3StickIndicator(int centerX, int centerY, String stickType) {
+void drawAtomS3StickIndicator(int centerX, int centerY, uint8_t stick) {
     // 小型画面用スティック表示（半径30）- 細い白い円の枠線
     int radius = 30;
-    M5.Display.drawCircle(centerX, centerY, radius, WHITE);
+    gfx->drawCircle(centerX, centerY, radius, WHITE);
     
     // カーソル位置計算
     int stickX, stickY;
-    if (stickType == "STICK_L") {
-        stickX = map(webButtons.lstick_x, -100, 100, centerX - radius + 5, centerX + radius - 5);
-        stickY = map(webButtons.lstick_y, -100, 100, centerY + radius - 5, centerY - radius + 5);
+    if (stick == INPUT_STICK_L) {
+        stickX = map(shown.input.lstick_x, -100, 100, centerX - radius + 5, centerX + radius - 5);
+        stickY = map(shown.input.lstick_y, -100, 100, centerY + radius - 5, centerY - radius + 5);
     } else { // STICK_R
-        stickX = map(webButtons.rstick_x, -100, 100, centerX - radius + 5, centerX + radius - 5);
-        stickY = map(webButtons.rstick_y, -100, 100, centerY + radius - 5, centerY - radius + 5);
+        stickX = map(shown.input.rstick_x, -100, 100, centerX - radius + 5, centerX + radius - 5);
+        stickY = map(shown.input.rstick_y, -100, 100, centerY + radius - 5, centerY - radius + 5);
     }
     
     // 「+」カーソルの描画（ルール仕様）
     int crossSize = 6;
     // 横線
-    M5.Display.drawLine(stickX - crossSize, stickY, stickX + crossSize, stickY, WHITE);
+    gfx->drawLine(stickX - crossSize, stickY, stickX + crossSize, stickY, WHITE);
     // 縦線  
-    M5.Display.drawLine(stickX, stickY - crossSize, stickX, stickY + crossSize, WHITE);
+    gfx->drawLine(stickX, stickY - crossSize, stickX, stickY + crossSize, WHITE);
     // 中央を少し太く
-    M5.Display.drawLine(stickX - crossSize + 1, stickY, stickX + crossSize - 1, stickY, WHITE);
-    M5.Display.drawLine(stickX, stickY - crossSize + 1, stickX, stickY + crossSize - 1, WHITE);
+    gfx->drawLine(stickX - crossSize + 1, stickY, stickX + crossSize - 1, stickY, WHITE);
+    gfx->drawLine(stickX, stickY - crossSize + 1, stickX, stickY + crossSize - 1, WHITE);
 }
 
 void updateDisplaySimpleMode() {
-    M5.Display.clear(BLACK);
+    const DisplayRegion header = {0, 0, LCD_WIDTH, 20};
+    const int centerX = LCD_WIDTH / 2;
+    const int centerY = LCD_HEIGHT / 2;
+    // スティック枠（半径80）と下の名前表示を含む範囲
+    const DisplayRegion indicator = {(int16_t)(centerX - 82), (int16_t)(centerY - 82), 164, 196};
     
     // WiFi状態表示（上部）
-    M5.Display.setCursor(10, 10);
-    M5.Display.setTextColor(WHITE);
-    M5.Display.setTextSize(1);
-    if (wifi_connected) {
-        M5.Display.setTextColor(CYAN);
-        M5.Display.print("WiFi: Connected | IP: " + wifi_ip);
-    } else {
-        M5.Display.setTextColor(RED);
-        M5.Display.print("WiFi: Disconnected");
+    if (headerChanged()) {
+        clearRegion(header);
+        gfx->setCursor(10, 10);
+        gfx->setTextSize(1);
+        if (shown.wifi_connected) {
+            gfx->setTextColor(CYAN);
+            gfx->print("WiFi: Connected | IP: ");
+            gfx->print(shown.ip);
+        } else if (shown.wifi_state == WIFI_STATE_CONNECTING) {
+            gfx->setTextColor(YELLOW);
+            gfx->print("WiFi: Connecting...");
+        } else {
+            gfx->setTextColor(RED);
+            gfx->print("WiFi: Disconnected");
+        }
+        pushRegion(header);
+        rememberHeader();
     }
     
-    // Web入力状態の確認と表示（中央）
-    String activeInput = getActiveWebInput();
-    if (activeInput != "") {
-        // 中央に大きく表示
-        int centerX = M5.Display.width() / 2;
-        int centerY = M5.Display.height() / 2;
-        
-        if (activeInput.startsWith("STICK_")) {
+    // Web入力状態の確認と表示（中央に大きく表示）
+    uint8_t input = activeInputId();
+    int16_t stickX, stickY;
+    activeStickPosition(input, stickX, stickY);
+    if (indicatorChanged(input, stickX, stickY)) {
+        clearRegion(indicator);
+        if (input == INPUT_STICK_L || input == INPUT_STICK_R) {
             // スティック表示
-            drawStickIndicator(centerX, centerY, activeInput);
-        } else {
+            drawStickIndicator(centerX, centerY, input);
+        } else if (input != INPUT_NONE) {
             // ボタン表示
-            drawButtonIndicator(centerX, centerY, activeInput);
+            drawButtonIndicator(centerX, centerY, inputName(input));
         }
+        pushRegion(indicator);
+        rememberIndicator(input, stickX, stickY);
     }
 }
 
-String getActiveWebInput() {
+uint8_t getActiveWebInput() {
     // 最新入力追跡機能を使用（複数入力時は最新のものを1つ表示）
-    if (webButtons.last_active_input != "") {
-        // 現在もその入力がアクティブかチェック
-        if (webButtons.last_active_input == "A" && webButtons.A) return "A";
-        if (webButtons.last_active_input == "B" && webButtons.B) return "B";
-        if (webButtons.last_active_input == "X" && webButtons.X) return "X";
-        if (webButtons.last_active_input == "Y" && webButtons.Y) return "Y";
-        if (webButtons.last_active_input == "L" && webButtons.L) return "L";
-        if (webButtons.last_active_input == "R" && webButtons.R) return "R";
-        if (webButtons.last_active_input == "ZL" && webButtons.ZL) return "ZL";
-        if (webButtons.last_active_input == "ZR" && webButtons.ZR) return "ZR";
-        if (webButtons.last_active_input == "+" && webButtons.plus) return "+";
-        if (webButtons.last_active_input == "-" && webButtons.minus) return "-";
-        if (webButtons.last_active_input == "HOME" && webButtons.home) return "HOME";
-        if (webButtons.last_active_input == "STICK_L" && (abs(webButtons.lstick_x) > 10 || abs(webButtons.lstick_y) > 10)) return "STICK_L";
-        if (webButtons.last_active_input == "STICK_R" && (abs(webButtons.rstick_x) > 10 || abs(webButtons.rstick_y) > 10)) return "STICK_R";
-        
-        // 最新入力がもうアクティブでない場合はクリア
-        webButtons.last_active_input = "";
-    }
-    
-    return ""; // デフォルト状態（何も表示しない）
+    // 最新入力が現在もアクティブな場合のみ表示（なければINPUT_NONE）
+    return activeInputId();
 }
 
-void drawButtonIndicator(int centerX, int centerY, String buttonName) {
+void drawButtonIndicator(int centerX, int centerY, const char *buttonName) {
     // 白い円の描画（大きめ）
     int radius = 60;
-    M5.Display.fillCircle(centerX, centerY, radius, WHITE);
-    M5.Display.drawCircle(centerX, centerY, radius, BLACK);
+    gfx->fillCircle(centerX, centerY, radius, WHITE);
+    gfx->drawCircle(centerX, centerY, radius, BLACK);
     
     // 黒字でボタン名を表示
-    M5.Display.setTextColor(BLACK);
-    M5.Display.setTextSize(4);
-    int textWidth = M5.Display.textWidth(buttonName);
+    gfx->setTextColor(BLACK);
+    gfx->setTextSize(4);
+    int textWidth = gfx->textWidth(buttonName);
     int textX = centerX - textWidth / 2;
     int textY = centerY - 16; // フォントサイズ4の場合の調整
-    M5.Display.setCursor(textX, textY);
-    M5.Display.print(buttonName);
+    gfx->setCursor(textX, textY);
+    gfx->print(buttonName);
 }
 
-void drawStickIndicator(int centerX, int centerY, String stickType) {
+void drawStickIndicator(int centerX, int centerY, uint8_t stick) {
     // スティックの枠（細く白い円）
     int radius = 80;
-    M5.Display.drawCircle(centerX, centerY, radius, WHITE);
-    M5.Display.drawCircle(centerX, centerY, radius - 1, WHITE); // 少し太く
+    gfx->drawCircle(centerX, centerY, radius, WHITE);
+    gfx->drawCircle(centerX, centerY, radius - 1, WHITE); // 少し太く
     
     // 十字カーソルの位置計算
     int stickX, stickY;
-    if (stickType == "STICK_L") {
-        stickX = map(webButtons.lstick_x, -100, 100, centerX - radius + 10, centerX + radius - 10);
-        stickY = map(webButtons.lstick_y, -100, 100, centerY + radius - 10, centerY - radius + 10); // Y軸反転
+    if (stick == INPUT_STICK_L) {
+        stickX = map(shown.input.lstick_x, -100, 100, centerX - radius + 10, centerX + radius - 10);
+        stickY = map(shown.input.lstick_y, -100, 100, centerY + radius - 10, centerY - radius + 10); // Y軸反転
     } else { // STICK_R
-        stickX = map(webButtons.rstick_x, -100, 100, centerX - radius + 10, centerX + radius - 10);
-        stickY = map(webButtons.rstick_y, -100, 100, centerY + radius - 10, centerY - radius + 10); // Y軸反転
+        stickX = map(shown.input.rstick_x, -100, 100, centerX - radius + 10, centerX + radius - 10);
+        stickY = map(shown.input.rstick_y, -100, 100, centerY + radius - 10, centerY - radius + 10); // Y軸反転
     }
     
     // 十字カーソルの描画
     int crossSize = 8;
-    M5.Display.drawLine(stickX - crossSize, stickY, stickX + crossSize, stickY, WHITE); // 横線
-    M5.Display.drawLine(stickX, stickY - crossSize, stickX, stickY + crossSize, WHITE); // 縦線
+    gfx->drawLine(stickX - crossSize, stickY, stickX + crossSize, stickY, WHITE); // 横線
+    gfx->drawLine(stickX, stickY - crossSize, stickX, stickY + crossSize, WHITE); // 縦線
     
     // 中央に小さい円
-    M5.Display.fillCircle(stickX, stickY, 3, WHITE);
+    gfx->fillCircle(stickX, stickY, 3, WHITE);
     
     // スティック名表示
-    M5.Display.setTextColor(WHITE);
-    M5.Display.setTextSize(2);
-    String displayName = (stickType == "STICK_L") ? "L-Stick" : "R-Stick";
-    int textWidth = M5.Display.textWidth(displayName);
-    M5.Display.setCursor(centerX - textWidth / 2, centerY + radius + 15);
-    M5.Display.print(displayName);
+    gfx->setTextColor(WHITE);
+    gfx->setTextSize(2);
+    const char *displayName = (stick == INPUT_STICK_L) ? "L-Stick" : "R-Stick";
+    int textWidth = gfx->textWidth(displayName);
+    gfx->setCursor(centerX - textWidth / 2, centerY + radius + 15);
+    gfx->print(displayName);
 }
 
-void updateDisplay() {
-    if (!HAS_LCD) {
-        // LED表示のみの場合
-        updateLEDDisplay();
-        return;
+// 表示内容のスナップショットを取得（loop()から呼ぶ）
+static void captureDisplaySnapshot(DisplaySnapshot &snap) {
+    // Web入力状態（取得失敗時は前回の状態）。タイムライン再生中はその状態を表示
+    if (isTimelineActive()) {
+        timelineInput.read(snap.input);
+    } else {
+        webInput.read(snap.input);
+        // ジッターバッファ使用時は送信したスティック値を表示
+        readStickPlayout(snap.input);
+    }
+    
+    snap.wifi_connected = wifi_connected;
+    snap.wifi_state = getWiFiLinkStats().state;
+    strncpy(snap.ip, wifi_ip, sizeof(snap.ip) - 1);
+    strncpy(snap.status, connection_status, sizeof(snap.status) - 1);
+    snap.switch_connected = switch_connected;
+    snap.press_count = button_press_count;
+    
+    snap.button_bits = 0;
+    for (size_t i = 0; i < TOUCH_BUTTON_COUNT; i++) {
+        snap.button_bits |= buttonDrawBits(touchButtons[i]) << (i * 2);
+    }
+}
+
+// shownの内容を描画して変化した領域を転送
+static void renderDisplay() {
+    uint32_t stamp = metricsStamp();
+    
+    if (canvasDma) {
+        // 前フレームのDMA転送が終わるまでCanvasを書き換えない
+        M5.Display.waitDMA();
+    } else {
+        M5.Display.startWrite();
+    }
+    
+    // 最初の1回は画面全体を消去して全領域を描画
+    if (!drawn.valid) {
+        const DisplayRegion screen = {0, 0, LCD_WIDTH, LCD_HEIGHT};
+        clearRegion(screen);
+        pushRegion(screen);
     }
     
     if (IS_ATOMS3) {
@@ -337,10 +502,93 @@ void updateDisplay() {
         // CoreS3のシンプルモード
         updateDisplaySimpleMode();
     }
+    drawn.valid = true;
+    
+    if (!canvasDma) {
+        M5.Display.endWrite();
+    }
+    recordStage(METRIC_DISPLAY, stamp);
+    
+    // 転送量を集計（直近1秒の値は1秒ごとに更新）
+    uint32_t now = millis();
+    portENTER_CRITICAL(&displayMux);
+    pushStats.frames++;
+    pushStats.bytes_total += frameBytes;
+    pushStats.pushes += framePushes;
+    pushWindowBytes += frameBytes;
+    if (now - pushWindowStart >= 1000) {
+        pushStats.bytes_per_sec = (uint32_t)((uint64_t)pushWindowBytes * 1000 / (now - pushWindowStart));
+        pushWindowBytes = 0;
+        pushWindowStart = now;
+    }
+    portEXIT_CRITICAL(&displayMux);
+    frameBytes = 0;
+    framePushes = 0;
+}
+
+// 表示タスクへスナップショットを渡す（未描画のものがあれば上書きして破棄）
+static void postDisplaySnapshot() {
+    captureDisplaySnapshot(loopSnapshot);
+    
+    portENTER_CRITICAL(&displayMux);
+    if (snapshotPending) {
+        pushStats.dropped++;
+    }
+    postedSnapshot = loopSnapshot;
+    snapshotPending = true;
+    portEXIT_CRITICAL(&displayMux);
+    
+    xTaskNotifyGive(displayTaskHandle);
+}
+
+static void displayTask(void *param) {
+    for (;;) {
+        // 通知は溜まらない（描画中に複数回通知されても1回だけ描画）
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        portENTER_CRITICAL(&displayMux);
+        shown = postedSnapshot;
+        snapshotPending = false;
+        portEXIT_CRITICAL(&displayMux);
+        
+        renderDisplay();
+    }
+}
+
+void updateDisplay() {
+    if (!HAS_LCD) {
+        // LED表示のみの場合
+        updateLEDDisplay();
+        return;
+    }
+    
+    // 表示タスク開始後は描画を任せる
+    if (displayTaskHandle != nullptr) {
+        postDisplaySnapshot();
+        return;
+    }
+    
+    captureDisplaySnapshot(loopSnapshot);
+    shown = loopSnapshot;
+    renderDisplay();
+}
+
+void startDisplayTask() {
+    if (!HAS_LCD || displayTaskHandle != nullptr) return;
+    
+    xTaskCreatePinnedToCore(displayTask, "display", DISPLAY_TASK_STACK, nullptr,
+                            DISPLAY_TASK_PRIORITY, &displayTaskHandle, DISPLAY_TASK_CORE);
+}
+
+DisplayPushStats getDisplayPushStats() {
+    portENTER_CRITICAL(&displayMux);
+    DisplayPushStats stats = pushStats;
+    portEXIT_CRITICAL(&displayMux);
+    return stats;
 }
 
 void checkAndUpdateDisplay() {
-    // ディスプレイ更新（設定値間隔）
+    // ディスプレイ更新（設定値間隔）。描画・転送は表示タスクで行う
     if (millis() - lastDisplayUpdate > DISPLAY_UPDATE_INTERVAL) {
         updateDisplay();
         lastDisplayUpdate = millis();
@@ -378,4 +626,25 @@ void initDisplay() {
     M5.Display.clear(BLACK);
     M5.Display.setBrightness(DISPLAY_BRIGHTNESS);
 #endif
+    
+    // 画面と同じサイズのオフスクリーン描画先
+    // DISPLAY_DMA_CANVAS_MAX以下なら内部RAM（DMA転送可）、超える場合やその確保に失敗した場合はPSRAM
+    int width = M5.Display.width();
+    int height = M5.Display.height();
+    canvas.setColorDepth(16);
+    canvas.setPsram(false);
+    if ((size_t)width * height * 2 <= DISPLAY_DMA_CANVAS_MAX && canvas.createSprite(width, height) != nullptr) {
+        canvasReady = true;
+        canvasDma = true;
+    } else if (psramFound()) {
+        canvas.setPsram(true);
+        canvasReady = canvas.createSprite(width, height) != nullptr;
+    }
+    gfx = canvasReady ? (lgfx::LovyanGFX *)&canvas : (lgfx::LovyanGFX *)&M5.Display;
+    drawn.valid = false;
+    
+    // DMA転送中にCPUが戻れるよう、LCDのバスは占有したままにする（endWrite()は転送完了を待つため）
+    if (canvasDma) {
+        M5.Display.startWrite();
+    }
 } 
\ No newline at end of file
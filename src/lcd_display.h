@@ -2,29 +2,36 @@
 #define LCD_DISPLAY_H
 
 #include "types.h"
-
-// Nintendo Switch ボタン
-extern TouchButton btnA;
-extern TouchButton btnB;
-extern TouchButton btnX;
-extern TouchButton btnY;
-
-// 左スティック
-extern TouchButton lstickUp;
-extern TouchButton lstickDown;
-extern TouchButton lstickLeft;
-extern TouchButton lstickRight;
-
-// 追加ボタン
-extern TouchButton btnPlus;
-extern TouchButton btnMinus;
-extern TouchButton btnHome;
+#include "report_pipeline.h"
+
+// タッチボタン（BUTTON_TABLEの先頭TOUCH_BUTTON_COUNT個と同じ並び）
+extern TouchButton touchButtons[TOUCH_BUTTON_COUNT];
+
+// 画面転送量（変化した領域のみ転送）
+struct DisplayPushStats {
+    uint64_t bytes_total = 0;     // 転送した累計バイト数
+    uint32_t pushes = 0;          // 転送した領域数
+    uint32_t bytes_per_sec = 0;   // 直近1秒の転送量
+    uint32_t frames = 0;          // 描画したフレーム数
+    uint32_t dropped = 0;         // 描画が間に合わず破棄したスナップショット数
+};
+
+// 表示内容のスナップショット（loop()で作成し表示タスクで描画）
+struct DisplaySnapshot {
+    ControllerState input;        // 表示する入力状態（タイムライン再生中はその状態）
+    bool wifi_connected = false;
+    uint8_t wifi_state = 0;       // WiFiLinkState
+    char ip[16] = "";
+    char status[48] = "";         // connection_status
+    bool switch_connected = false;
+    int press_count = 0;
+    uint32_t button_bits = 0;     // タッチモードのボタン表示状態（2bit/ボタン）
+};
 
 // 表示状態管理
 extern unsigned long lastDisplayUpdate;
-extern String connection_status;
+extern const char *connection_status;   // 表示する接続状態（文字列リテラルを指す）
 extern bool switch_connected;
-extern int button_press_count;
 
 /**
  * ディスプレイ更新（タッチ有効モード）
@@ -51,15 +58,25 @@ void updateLEDDisplay();
  */
 void updateDisplay();
 
+/**
+ * 画面転送量を取得
+ */
+DisplayPushStats getDisplayPushStats();
+
+/**
+ * 表示タスク開始（以降の描画・転送は表示タスクで実行）
+ */
+void startDisplayTask();
+
 /**
  * ディスプレイ更新チェック・実行
  */
 void checkAndUpdateDisplay();
 
 /**
- * ボタン描画
+ * ボタン描画（state: bit0=押下、bit1=Web入力）
  */
-void drawButton(TouchButton &btn);
+void drawButton(const ButtonDescriptor &button, uint8_t state);
 
 /**
  * ディスプレイ初期化
@@ -67,28 +84,28 @@ void drawButton(TouchButton &btn);
 void initDisplay();
 
 /**
- * アクティブなWeb入力を取得
+ * アクティブなWeb入力を取得（表示中の最新入力、なければINPUT_NONE）
  */
-String getActiveWebInput();
+uint8_t getActiveWebInput();
 
 /**
  * ボタンインジケーター描画
  */
-void drawButtonIndicator(int centerX, int centerY, String buttonName);
+void drawButtonIndicator(int centerX, int centerY, const char *buttonName);
 
 /**
- * スティックインジケーター描画
+ * スティックインジケーター描画（stick: INPUT_STICK_L/INPUT_STICK_R）
  */
-void drawStickIndicator(int centerX, int centerY, String stickType);
+void drawStickIndicator(int centerX, int centerY, uint8_t stick);
 
 /**
  * AtomS3用ボタンインジケーター描画
  */
-void drawAtomS3ButtonIndicator(int centerX, int centerY, String buttonName);
+void drawAtomS3ButtonIndicator(int centerX, int centerY, const char *buttonName);
 
 /**
- * AtomS3用スティックインジケーター描画
+ * AtomS3用スティックインジケーター描画（stick: INPUT_STICK_L/INPUT_STICK_R）
  */
-void drawAtomS3StickIndicator(int centerX, int centerY, String stickType);
+void drawAtomS3StickIndicator(int centerX, int centerY, uint8_t stick);
 
 #endif // LCD_DISPLAY_H 
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "macro_codec.h"
+#include <string.h>
+
+static size_t writeVarint(uint32_t value, uint8_t *out) {
+    size_t n = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[n++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    return n;
+}
+
+static size_t readVarint(const uint8_t *data, size_t length, uint32_t &value) {
+    value = 0;
+    for (size_t i = 0; i < length && i < 5; i++) {
+        value |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0) return i + 1;
+    }
+    return 0;
+}
+
+static size_t writeInt16(int16_t value, uint8_t *out) {
+    memcpy(out, &value, sizeof(value));
+    return sizeof(value);
+}
+
+size_t encodeMacroRecord(const ControllerState &previous, const ControllerState &next,
+                         uint32_t duration_ms, bool keyframe, uint8_t *out) {
+    uint8_t flags = 0;
+    if (keyframe) {
+        flags = MACRO_FIELD_ALL;
+    } else {
+        if (next.buttons != previous.buttons) flags |= MACRO_FIELD_BUTTONS;
+        if (next.hat != previous.hat) flags |= MACRO_FIELD_HAT;
+        if (next.lstick_x != previous.lstick_x) flags |= MACRO_FIELD_LX;
+        if (next.lstick_y != previous.lstick_y) flags |= MACRO_FIELD_LY;
+        if (next.rstick_x != previous.rstick_x) flags |= MACRO_FIELD_RX;
+        if (next.rstick_y != previous.rstick_y) flags |= MACRO_FIELD_RY;
+    }
+
+    size_t n = 0;
+    out[n++] = flags;
+    n += writeVarint(duration_ms, out + n);
+    if (flags & MACRO_FIELD_BUTTONS) {
+        memcpy(out + n, &next.buttons, sizeof(next.buttons));
+        n += sizeof(next.buttons);
+    }
+    if (flags & MACRO_FIELD_HAT) out[n++] = next.hat;
+    if (flags & MACRO_FIELD_LX) n += writeInt16(next.lstick_x, out + n);
+    if (flags & MACRO_FIELD_LY) n += writeInt16(next.lstick_y, out + n);
+    if (flags & MACRO_FIELD_RX) n += writeInt16(next.rstick_x, out + n);
+    if (flags & MACRO_FIELD_RY) n += writeInt16(next.rstick_y, out + n);
+    return n;
+}
+
+size_t decodeMacroRecord(const uint8_t *data, size_t length, ControllerState &state, uint32_t &duration_ms) {
+    if (length < 2) return 0;
+
+    uint8_t flags = data[0];
+    if (flags & ~MACRO_FIELD_ALL) return 0;
+
+    size_t n = 1;
+    size_t varint = readVarint(data + n, length - n, duration_ms);
+    if (varint == 0) return 0;
+    n += varint;
+
+    // 必要なバイト数を先に確認
+    size_t need = 0;
+    if (flags & MACRO_FIELD_BUTTONS) need += 2;
+    if (flags & MACRO_FIELD_HAT) need += 1;
+    for (uint8_t bit = MACRO_FIELD_LX; bit <= MACRO_FIELD_RY; bit <<= 1) {
+        if (flags & bit) need += 2;
+    }
+    if (length - n < need) return 0;
+
+    if (flags & MACRO_FIELD_BUTTONS) {
+        memcpy(&state.buttons, data + n, 2);
+        n += 2;
+    }
+    if (flags & MACRO_FIELD_HAT) state.hat = data[n++];
+    if (flags & MACRO_FIELD_LX) { memcpy(&state.lstick_x, data + n, 2); n += 2; }
+    if (flags & MACRO_FIELD_LY) { memcpy(&state.lstick_y, data + n, 2); n += 2; }
+    if (flags & MACRO_FIELD_RX) { memcpy(&state.rstick_x, data + n, 2); n += 2; }
+    if (flags & MACRO_FIELD_RY) { memcpy(&state.rstick_y, data + n, 2); n += 2; }
+    return n;
+}
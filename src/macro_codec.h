@@ -0,0 +1,47 @@
+#ifndef MACRO_CODEC_H
+#define MACRO_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "controller_state.h"
+
+// マクロファイル形式（リトルエンディアン）
+// [ヘッダー16byte][レコード...]
+// レコード: [変更フラグ1byte][保持時間ms（LEB128可変長）][変更されたフィールドのみ]
+#define MACRO_MAGIC 0x314D5753      // "SWM1"
+#define MACRO_VERSION 1
+
+// 変更フラグ
+#define MACRO_FIELD_BUTTONS 0x01    // uint16
+#define MACRO_FIELD_HAT     0x02    // uint8
+#define MACRO_FIELD_LX      0x04    // int16
+#define MACRO_FIELD_LY      0x08    // int16
+#define MACRO_FIELD_RX      0x10    // int16
+#define MACRO_FIELD_RY      0x20    // int16
+#define MACRO_FIELD_ALL     0x3F
+
+// 1レコードの最大サイズ（フラグ1 + 可変長5 + フィールド2+1+2×4）
+#define MACRO_RECORD_MAX 17
+
+struct __attribute__((packed)) MacroHeader {
+    uint32_t magic = MACRO_MAGIC;
+    uint8_t version = MACRO_VERSION;
+    uint8_t reserved[3] = {0, 0, 0};
+    uint32_t frame_count = 0;      // レコード数
+    uint32_t duration_ms = 0;      // 合計再生時間（ms）
+};
+
+/**
+ * 1フレームを前フレームとの差分でエンコード（keyframe=trueなら全フィールド）
+ * 書き込んだバイト数を返す（outはMACRO_RECORD_MAX以上）
+ */
+size_t encodeMacroRecord(const ControllerState &previous, const ControllerState &next,
+                         uint32_t duration_ms, bool keyframe, uint8_t *out);
+
+/**
+ * 1レコードをデコードしてstateへ上書き
+ * 消費したバイト数を返す（データ不足・不正時は0）
+ */
+size_t decodeMacroRecord(const uint8_t *data, size_t length, ControllerState &state, uint32_t &duration_ms);
+
+#endif // MACRO_CODEC_H
@@ -0,0 +1,301 @@
+#include "macro_store.h"
+#include "macro_codec.h"
+#include "env.h"
+#include <LittleFS.h>
+
+#define MACRO_DIR "/macros"
+#define MACRO_EXT ".mac"
+
+// 再生状態
+static MacroStatus macroStatus;
+static portMUX_TYPE macroMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t macroTaskHandle = nullptr;
+static std::atomic<bool> stopRequested{false};
+static std::atomic<bool> macroPlaying{false};
+static bool fs_ready = false;
+
+// ファイル読み出し・書き込みバッファ
+static uint8_t readBuffer[MACRO_IO_BUFFER];
+static uint8_t writeBuffer[MACRO_IO_BUFFER];
+
+static void macroPath(const char *name, char *path, size_t size) {
+    snprintf(path, size, MACRO_DIR "/%s" MACRO_EXT, name);
+}
+
+bool isValidMacroName(const char *name) {
+    size_t length = 0;
+    for (const char *p = name; *p; p++, length++) {
+        char c = *p;
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '_' || c == '-';
+        if (!ok || length >= MACRO_NAME_MAX) return false;
+    }
+    return length > 0;
+}
+
+static bool readHeader(File &file, MacroHeader &header) {
+    file.seek(0);
+    if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header)) return false;
+    return header.magic == MACRO_MAGIC && header.version == MACRO_VERSION;
+}
+
+MacroWriteResult writeMacroFrames(const char *name, const TimelineFrame *frames, size_t count,
+                                  bool append, MacroInfo *info) {
+    if (!isValidMacroName(name)) return MACRO_WRITE_INVALID_NAME;
+    if (!fs_ready) return MACRO_WRITE_FS_ERROR;
+
+    // 再生タスクが読み出し中のファイルを切り詰め・書き換えない
+    portENTER_CRITICAL(&macroMux);
+    bool playing = macroStatus.playing && strcmp(macroStatus.name, name) == 0;
+    portEXIT_CRITICAL(&macroMux);
+    if (playing) return MACRO_WRITE_PLAYING;
+
+    char path[48];
+    macroPath(name, path, sizeof(path));
+
+    MacroHeader header;
+    File file;
+    if (append) {
+        if (!LittleFS.exists(path)) return MACRO_WRITE_NOT_FOUND;
+        file = LittleFS.open(path, "r+");
+        if (!file || !readHeader(file, header)) return MACRO_WRITE_FS_ERROR;
+        file.seek(0, SeekEnd);
+    } else {
+        file = LittleFS.open(path, "w");
+        if (!file) return MACRO_WRITE_FS_ERROR;
+        file.write((const uint8_t *)&header, sizeof(header));
+    }
+
+    // 追記の先頭は前の状態が分からないため全フィールドを書く
+    ControllerState previous;
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (used + MACRO_RECORD_MAX > sizeof(writeBuffer)) {
+            file.write(writeBuffer, used);
+            used = 0;
+        }
+        used += encodeMacroRecord(previous, frames[i].state, frames[i].duration_ms, i == 0, writeBuffer + used);
+        previous = frames[i].state;
+        header.frame_count++;
+        header.duration_ms += frames[i].duration_ms;
+    }
+    if (used > 0) {
+        file.write(writeBuffer, used);
+    }
+
+    // ヘッダーのフレーム数・合計時間を更新
+    file.seek(0);
+    file.write((const uint8_t *)&header, sizeof(header));
+
+    if (info != nullptr) {
+        strncpy(info->name, name, MACRO_NAME_MAX);
+        info->name[MACRO_NAME_MAX] = '\0';
+        info->frames = header.frame_count;
+        info->duration_ms = header.duration_ms;
+        info->bytes = file.size();
+    }
+    file.close();
+    return MACRO_WRITE_OK;
+}
+
+size_t listMacros(MacroInfo *out, size_t max) {
+    if (!fs_ready) return 0;
+
+    File dir = LittleFS.open(MACRO_DIR);
+    if (!dir || !dir.isDirectory()) return 0;
+
+    size_t count = 0;
+    File entry;
+    while (count < max && (entry = dir.openNextFile())) {
+        const char *fileName = entry.name();
+        const char *ext = strstr(fileName, MACRO_EXT);
+        MacroHeader header;
+        if (ext == nullptr || !readHeader(entry, header)) continue;
+
+        size_t nameLength = ext - fileName;
+        if (nameLength > MACRO_NAME_MAX) nameLength = MACRO_NAME_MAX;
+        memcpy(out[count].name, fileName, nameLength);
+        out[count].name[nameLength] = '\0';
+        out[count].frames = header.frame_count;
+        out[count].duration_ms = header.duration_ms;
+        out[count].bytes = entry.size();
+        count++;
+    }
+    return count;
+}
+
+bool deleteMacro(const char *name) {
+    if (!fs_ready || !isValidMacroName(name)) return false;
+
+    char path[48];
+    macroPath(name, path, sizeof(path));
+    return LittleFS.remove(path);
+}
+
+// ファイルから読み出しバッファを補充（未消費分を先頭へ詰める）
+static size_t refillBuffer(File &file, size_t &start, size_t &length) {
+    if (start > 0) {
+        memmove(readBuffer, readBuffer + start, length);
+        start = 0;
+    }
+    int read = file.read(readBuffer + length, sizeof(readBuffer) - length);
+    if (read > 0) length += read;
+    return length;
+}
+
+// マクロ1周分をタイムラインへ供給（停止要求時はfalse）
+static bool feedMacroOnce(File &file, uint16_t sequenceId) {
+    file.seek(sizeof(MacroHeader));
+
+    size_t start = 0, length = 0;
+    ControllerState state, previous;
+    TimelineFrame batch[MACRO_FEED_BATCH];
+    size_t batchCount = 0;
+    bool eof = false;
+
+    while (!stopRequested.load()) {
+        // 1レコード分に満たなければファイルから補充
+        if (!eof && length < MACRO_RECORD_MAX) {
+            size_t before = length;
+            refillBuffer(file, start, length);
+            if (length == before) eof = true;
+        }
+
+        uint32_t duration = 0;
+        size_t used = length > 0 ? decodeMacroRecord(readBuffer + start, length, state, duration) : 0;
+        if (used > 0) {
+            start += used;
+            length -= used;
+            trackLatestInput(previous, state, 0);
+            previous = state;
+            batch[batchCount].state = state;
+            batch[batchCount].duration_ms = duration;
+            batch[batchCount].sequence_id = sequenceId;
+            batchCount++;
+        }
+
+        // 終端、またはデコードできないレコード（破損）で終了
+        bool finished = used == 0 && (eof || length >= MACRO_RECORD_MAX);
+        if (batchCount == MACRO_FEED_BATCH || (finished && batchCount > 0)) {
+            // キューに空きができるまで待つ
+            while (timelineFreeFrames() < batchCount) {
+                if (stopRequested.load()) return false;
+                vTaskDelay(pdMS_TO_TICKS(MACRO_FEED_INTERVAL_MS));
+            }
+            // 再生済みでキューが空になっていたら供給遅れ
+            bool underrun = macroStatus.fed_frames > 0 && !isTimelineActive();
+            queueTimeline(batch, batchCount);
+
+            portENTER_CRITICAL(&macroMux);
+            macroStatus.fed_frames += batchCount;
+            if (underrun) macroStatus.underruns++;
+            portEXIT_CRITICAL(&macroMux);
+            batchCount = 0;
+        }
+
+        if (finished) return true;
+    }
+    return false;
+}
+
+static void playMacro() {
+    MacroStatus status = getMacroStatus();
+    char path[48];
+    macroPath(status.name, path, sizeof(path));
+
+    File file = LittleFS.open(path, "r");
+    MacroHeader header;
+    if (file && readHeader(file, header)) {
+        uint16_t sequenceId = nextTimelineId();
+        for (uint32_t loop = 0; status.repeat == 0 || loop < status.repeat; loop++) {
+            if (!feedMacroOnce(file, sequenceId)) break;
+
+            portENTER_CRITICAL(&macroMux);
+            macroStatus.loops_done++;
+            macroStatus.fed_frames = 0;
+            portEXIT_CRITICAL(&macroMux);
+        }
+        file.close();
+
+        // 最後まで供給したら再生終了を待つ
+        while (!stopRequested.load() && isTimelineActive()) {
+            vTaskDelay(pdMS_TO_TICKS(MACRO_FEED_INTERVAL_MS));
+        }
+    }
+
+    portENTER_CRITICAL(&macroMux);
+    macroStatus.playing = false;
+    portEXIT_CRITICAL(&macroMux);
+    macroPlaying.store(false);
+}
+
+static void macroTask(void *param) {
+    for (;;) {
+        // 再生開始要求を待つ
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        playMacro();
+    }
+}
+
+void initMacroStore() {
+    fs_ready = LittleFS.begin(true);
+    if (fs_ready && !LittleFS.exists(MACRO_DIR)) {
+        LittleFS.mkdir(MACRO_DIR);
+    }
+
+    xTaskCreatePinnedToCore(macroTask, "macro", MACRO_TASK_STACK, nullptr,
+                            MACRO_TASK_PRIORITY, &macroTaskHandle, MACRO_TASK_CORE);
+}
+
+bool startMacro(const char *name, uint32_t repeat) {
+    if (!fs_ready || !isValidMacroName(name) || macroTaskHandle == nullptr) return false;
+
+    char path[48];
+    macroPath(name, path, sizeof(path));
+    if (!LittleFS.exists(path)) return false;
+
+    // 再生中なら停止してから開始
+    stopMacro();
+
+    File file = LittleFS.open(path, "r");
+    MacroHeader header;
+    bool valid = file && readHeader(file, header);
+    file.close();
+    if (!valid) return false;
+
+    portENTER_CRITICAL(&macroMux);
+    macroStatus = MacroStatus();
+    macroStatus.playing = true;
+    strncpy(macroStatus.name, name, MACRO_NAME_MAX);
+    macroStatus.total_frames = header.frame_count;
+    macroStatus.repeat = repeat;
+    portEXIT_CRITICAL(&macroMux);
+
+    stopRequested.store(false);
+    macroPlaying.store(true);
+    xTaskNotifyGive(macroTaskHandle);
+    return true;
+}
+
+void stopMacro() {
+    if (!macroPlaying.load()) return;
+
+    stopRequested.store(true);
+
+    // 再生タスクの終了を待ってから、供給済みのフレームを破棄
+    while (macroPlaying.load()) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    abortTimeline();
+}
+
+bool isMacroPlaying() {
+    return macroPlaying.load();
+}
+
+MacroStatus getMacroStatus() {
+    portENTER_CRITICAL(&macroMux);
+    MacroStatus copy = macroStatus;
+    portEXIT_CRITICAL(&macroMux);
+    return copy;
+}
@@ -0,0 +1,84 @@
+#ifndef MACRO_STORE_H
+#define MACRO_STORE_H
+
+#include "types.h"
+#include "input_scheduler.h"
+
+// マクロ名の最大長（英数字・'_'・'-'）
+#define MACRO_NAME_MAX 24
+
+// 保存済みマクロの情報
+struct MacroInfo {
+    char name[MACRO_NAME_MAX + 1];
+    uint32_t frames = 0;        // フレーム数
+    uint32_t duration_ms = 0;   // 合計再生時間（ms）
+    uint32_t bytes = 0;         // ファイルサイズ
+};
+
+// マクロ再生状態
+struct MacroStatus {
+    bool playing = false;
+    char name[MACRO_NAME_MAX + 1] = "";
+    uint32_t total_frames = 0;     // 再生中マクロのフレーム数
+    uint32_t fed_frames = 0;       // タイムラインへ送ったフレーム数（今回の周回）
+    uint32_t loops_done = 0;       // 完了した周回数
+    uint32_t repeat = 0;           // 指定周回数（0=無限）
+    uint32_t underruns = 0;        // 供給が間に合わずキューが空になった回数
+};
+
+// マクロ保存結果
+enum MacroWriteResult : uint8_t {
+    MACRO_WRITE_OK = 0,
+    MACRO_WRITE_INVALID_NAME,
+    MACRO_WRITE_NOT_FOUND,     // 追記先が存在しない
+    MACRO_WRITE_PLAYING,       // 再生中のマクロ（再生タスクが読み出し中のため書き換えない）
+    MACRO_WRITE_FS_ERROR,
+};
+
+/**
+ * マクロ保存領域（LittleFS）と再生タスクの初期化
+ */
+void initMacroStore();
+
+/**
+ * マクロ名が有効か（英数字・'_'・'-'、1〜MACRO_NAME_MAX文字）
+ */
+bool isValidMacroName(const char *name);
+
+/**
+ * フレーム列を差分エンコードして保存（append=trueなら既存マクロの末尾に追記）
+ */
+MacroWriteResult writeMacroFrames(const char *name, const TimelineFrame *frames, size_t count,
+                                  bool append, MacroInfo *info);
+
+/**
+ * 保存済みマクロ一覧を取得（取得数を返す）
+ */
+size_t listMacros(MacroInfo *out, size_t max);
+
+/**
+ * マクロを削除
+ */
+bool deleteMacro(const char *name);
+
+/**
+ * マクロ再生開始（repeat=0で停止するまで繰り返し）
+ */
+bool startMacro(const char *name, uint32_t repeat);
+
+/**
+ * マクロ再生停止
+ */
+void stopMacro();
+
+/**
+ * マクロ再生中かどうか
+ */
+bool isMacroPlaying();
+
+/**
+ * マクロ再生状態を取得
+ */
+MacroStatus getMacroStatus();
+
+#endif // MACRO_STORE_H
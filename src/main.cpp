@@ -2,18 +2,23 @@
 #include "env.h"
 #include "wifi_manager.h"
 #include "web_server.h"
+#include "async_http.h"
+#include "udp_input.h"
+#include "ws_input.h"
+#include "input_scheduler.h"
+#include "macro_store.h"
 #include "controller_input.h"
 #include "touch_control.h"
 #include "lcd_display.h"
+#include "metrics.h"
+#include "soak_monitor.h"
+#include "stick_curve.h"
 
 // Nintendo Switch Controller - M5CoreS3タッチスクリーン実装 + Webサーバー機能
 // SwitchControllerESP32ライブラリ使用（Nintendo Switch専用）
 
 // WebServer（実体）
-WebServer server(WEB_SERVER_PORT);
-
-// Web入力状態（実体）
-WebButtonState webButtons;
+WebServer server(WEB_ADMIN_PORT);
 
 void setup() {
     // M5デバイス初期化（ボード別設定）
@@ -47,40 +52,73 @@ void setup() {
     // タッチ制御初期化
     initTouchControl();
     
-    // WiFi初期化
+    // WiFi接続開始（接続完了は待たない）
     initWiFi();
     
     // Nintendo Switchコントローラー初期化
     initController();
     
+    // スティックの応答カーブ初期化
+    initStickCurves();
+    
+    // タイムライン再生初期化
+    initInputScheduler();
+    
+    // マクロ保存領域・再生タスク初期化
+    initMacroStore();
+    
     // Webサーバー初期化
     initWebServer();
     
+    // 非同期HTTP初期化（/controllerをloop()を待たずに処理）
+    initAsyncHttp();
+    
+    // UDP入力受信開始
+    initUdpInput();
+    
+    // WebSocket入力受信開始
+    initWebSocketInput();
+    
+    // USBレポート送信タスク開始（以降のレポート送信は固定周期で実行）
+    startReportTask();
+    
     connection_status = "Nintendo Switch接続準備完了!";
     switch_connected = true;
     
     // 初期画面表示
     updateDisplay();
+    
+    // 表示タスク開始（以降の描画はloop()から切り離して実行）
+    startDisplayTask();
 }
 
 void loop() {
-    // WiFi接続チェック・再接続
+    uint32_t loopStamp = metricsStamp();
+    
+    // WiFi接続状態の更新・再接続（ブロックしない）
     reconnectWiFi();
     
     // Webサーバー処理
     handleWebServer();
     
+    // UDP入力処理
+    handleUdpInput();
+    
+    // WebSocket入力処理
+    handleWebSocketInput();
+    
     // Web入力更新
     updateWebInput();
     
     // タッチ状態更新
     updateTouch();
     
-    // Nintendo Switchコントローラー更新
-    updateSwitchController();
-    
     // ディスプレイ更新チェック・実行
     checkAndUpdateDisplay();
     
+    // ヒープ状態の記録（長時間稼働試験時のみ）
+    updateSoakMonitor();
+    
+    recordStage(METRIC_LOOP, loopStamp);
     delay(MAIN_LOOP_DELAY);  // Nintendo Switch用の最適化された遅延
 }
\ No newline at end of file
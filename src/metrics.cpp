@@ -0,0 +1,319 @@
+#include "metrics.h"
+#include "lcd_display.h"
+#include "controller_input.h"
+#include "wifi_manager.h"
+#include "soak_monitor.h"
+#include "input_edges.h"
+#include "input_clock.h"
+#include "stick_jitter.h"
+#include "usb_poll_sync.h"
+#include "env.h"
+#include <esp_timer.h>
+#include <stdarg.h>
+
+// サイクルカウンタはコアごとに独立のため、区間をまたぐ計測（公開→送信）は
+// loop()とレポート送信タスクが同じコアの場合のみ使用。異なる場合はesp_timerで代用
+#if REPORT_TASK_CORE == ARDUINO_RUNNING_CORE
+#define METRICS_USE_CYCLE_COUNTER
+#endif
+
+// バケット上限（us）とPrometheus出力用のラベル（秒）
+static const uint32_t BUCKET_LIMIT_US[METRIC_BUCKET_COUNT - 1] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000
+};
+static const char *const BUCKET_LABEL[METRIC_BUCKET_COUNT] = {
+    "0.00005", "0.0001", "0.00025", "0.0005", "0.001", "0.0025",
+    "0.005", "0.01", "0.025", "0.05", "0.1", "+Inf"
+};
+static const char *const STAGE_NAME[METRIC_STAGE_COUNT] = {
+    "http_receive", "http_parse", "input_apply", "report_emit",
+    "loop", "handle_client", "display"
+};
+
+// 区間ごとのヒストグラム（バケットは非累積で保持し、出力時に累積）
+struct LatencyHistogram {
+    uint32_t buckets[METRIC_BUCKET_COUNT] = {};
+    uint32_t count = 0;
+    uint64_t sum_us = 0;
+};
+
+static LatencyHistogram histograms[METRIC_STAGE_COUNT];
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 未反映・未送信の公開時刻（0=なし）
+static std::atomic<uint32_t> applyPending{0};
+static std::atomic<uint32_t> emitPending{0};
+
+static uint32_t cyclesPerUs = 0;
+
+uint32_t metricsStamp() {
+#ifdef METRICS_USE_CYCLE_COUNTER
+    return ESP.getCycleCount();
+#else
+    return (uint32_t)esp_timer_get_time();
+#endif
+}
+
+static uint32_t elapsedUs(uint32_t start, uint32_t end) {
+#ifdef METRICS_USE_CYCLE_COUNTER
+    if (cyclesPerUs == 0) cyclesPerUs = ESP.getCpuFreqMHz();
+    return (end - start) / cyclesPerUs;
+#else
+    return end - start;
+#endif
+}
+
+static void recordStageUs(MetricStage stage, uint32_t us) {
+    size_t bucket = 0;
+    while (bucket < METRIC_BUCKET_COUNT - 1 && us > BUCKET_LIMIT_US[bucket]) {
+        bucket++;
+    }
+
+    portENTER_CRITICAL(&metricsMux);
+    LatencyHistogram &h = histograms[stage];
+    h.buckets[bucket]++;
+    h.count++;
+    h.sum_us += us;
+    portEXIT_CRITICAL(&metricsMux);
+}
+
+void recordStage(MetricStage stage, uint32_t start) {
+    recordStageUs(stage, elapsedUs(start, metricsStamp()));
+}
+
+void markInputPublished(uint32_t stamp) {
+    if (stamp == 0) stamp = 1;
+    applyPending.store(stamp, std::memory_order_relaxed);
+
+    // 送信前に複数回公開された場合は最初の公開から計測
+    uint32_t none = 0;
+    emitPending.compare_exchange_strong(none, stamp, std::memory_order_relaxed);
+}
+
+void recordInputApplied() {
+    uint32_t stamp = applyPending.exchange(0, std::memory_order_relaxed);
+    if (stamp != 0) {
+        recordStage(METRIC_INPUT_APPLY, stamp);
+    }
+}
+
+void recordReportEmitted() {
+    uint32_t stamp = emitPending.exchange(0, std::memory_order_relaxed);
+    if (stamp != 0) {
+        recordStage(METRIC_REPORT_EMIT, stamp);
+    }
+}
+
+// outの末尾に追記（バッファ不足時は切り詰め）
+static size_t appendf(char *out, size_t size, size_t n, const char *format, ...) {
+    if (n >= size) return n;
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out + n, size - n, format, args);
+    va_end(args);
+
+    if (written < 0) return n;
+    return n + written < size ? n + written : size - 1;
+}
+
+static size_t formatHistogram(MetricStage stage, char *out, size_t size) {
+    portENTER_CRITICAL(&metricsMux);
+    LatencyHistogram h = histograms[stage];
+    portEXIT_CRITICAL(&metricsMux);
+
+    size_t n = 0;
+    uint32_t cumulative = 0;
+    for (size_t i = 0; i < METRIC_BUCKET_COUNT; i++) {
+        cumulative += h.buckets[i];
+        n = appendf(out, size, n, "m5s3_stage_latency_seconds_bucket{stage=\"%s\",le=\"%s\"} %lu\n",
+                    STAGE_NAME[stage], BUCKET_LABEL[i], (unsigned long)cumulative);
+    }
+    n = appendf(out, size, n, "m5s3_stage_latency_seconds_sum{stage=\"%s\"} %lu.%06lu\n",
+                STAGE_NAME[stage],
+                (unsigned long)(h.sum_us / 1000000),
+                (unsigned long)(h.sum_us % 1000000));
+    n = appendf(out, size, n, "m5s3_stage_latency_seconds_count{stage=\"%s\"} %lu\n",
+                STAGE_NAME[stage], (unsigned long)h.count);
+    return n;
+}
+
+size_t formatMetricsSection(size_t index, char *out, size_t size) {
+    if (index == 0) {
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_stage_latency_seconds Time spent per pipeline stage.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_stage_latency_seconds histogram\n");
+        return n;
+    }
+
+    if (index <= METRIC_STAGE_COUNT) {
+        return formatHistogram((MetricStage)(index - 1), out, size);
+    }
+
+    if (index == METRIC_STAGE_COUNT + 1) {
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_free_heap_bytes Free heap.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_free_heap_bytes gauge\n");
+        n = appendf(out, size, n, "m5s3_free_heap_bytes %lu\n", (unsigned long)ESP.getFreeHeap());
+        n = appendf(out, size, n, "# HELP m5s3_min_free_heap_bytes Lowest free heap since boot.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_min_free_heap_bytes gauge\n");
+        n = appendf(out, size, n, "m5s3_min_free_heap_bytes %lu\n", (unsigned long)ESP.getMinFreeHeap());
+        n = appendf(out, size, n, "# HELP m5s3_button_press_total Button presses sent to the Switch.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_button_press_total counter\n");
+        n = appendf(out, size, n, "m5s3_button_press_total %d\n", button_press_count);
+        n = appendf(out, size, n, "# HELP m5s3_reports_total Report cycles (sent and suppressed).\n");
+        n = appendf(out, size, n, "# TYPE m5s3_reports_total counter\n");
+        n = appendf(out, size, n, "m5s3_reports_total %lu\n", (unsigned long)getReportFrame());
+        DisplayPushStats display = getDisplayPushStats();
+        n = appendf(out, size, n, "# HELP m5s3_display_pushed_bytes_total Bytes pushed to the LCD.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_display_pushed_bytes_total counter\n");
+        n = appendf(out, size, n, "m5s3_display_pushed_bytes_total %llu\n", (unsigned long long)display.bytes_total);
+        n = appendf(out, size, n, "# HELP m5s3_display_pushed_bytes_per_second Bytes pushed to the LCD in the last second.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_display_pushed_bytes_per_second gauge\n");
+        n = appendf(out, size, n, "m5s3_display_pushed_bytes_per_second %lu\n", (unsigned long)display.bytes_per_sec);
+        n = appendf(out, size, n, "# HELP m5s3_display_frames_total Frames rendered by the display task.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_display_frames_total counter\n");
+        n = appendf(out, size, n, "m5s3_display_frames_total %lu\n", (unsigned long)display.frames);
+        n = appendf(out, size, n, "# HELP m5s3_display_dropped_total Display snapshots dropped while rendering.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_display_dropped_total counter\n");
+        n = appendf(out, size, n, "m5s3_display_dropped_total %lu\n", (unsigned long)display.dropped);
+        return n;
+    }
+
+    if (index == METRIC_STAGE_COUNT + 2) {
+        WiFiLinkStats wifi = getWiFiLinkStats();
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_wifi_state WiFi link state (0=idle, 1=connecting, 2=connected, 3=backoff).\n");
+        n = appendf(out, size, n, "# TYPE m5s3_wifi_state gauge\n");
+        n = appendf(out, size, n, "m5s3_wifi_state %u\n", (unsigned)wifi.state);
+        n = appendf(out, size, n, "# HELP m5s3_wifi_connect_attempts_total WiFi connection attempts.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_wifi_connect_attempts_total counter\n");
+        n = appendf(out, size, n, "m5s3_wifi_connect_attempts_total %lu\n", (unsigned long)wifi.attempts);
+        n = appendf(out, size, n, "# HELP m5s3_wifi_disconnects_total WiFi link drops after connecting.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_wifi_disconnects_total counter\n");
+        n = appendf(out, size, n, "m5s3_wifi_disconnects_total %lu\n", (unsigned long)wifi.disconnects);
+        n = appendf(out, size, n, "# HELP m5s3_wifi_backoff_seconds Current wait before the next connection attempt.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_wifi_backoff_seconds gauge\n");
+        n = appendf(out, size, n, "m5s3_wifi_backoff_seconds %lu.%03lu\n",
+                    (unsigned long)(wifi.backoff_ms / 1000), (unsigned long)(wifi.backoff_ms % 1000));
+        n = appendf(out, size, n, "# HELP m5s3_wifi_rssi_dbm WiFi signal strength.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_wifi_rssi_dbm gauge\n");
+        n = appendf(out, size, n, "m5s3_wifi_rssi_dbm %d\n", wifi.state == WIFI_STATE_CONNECTED ? (int)WiFi.RSSI() : 0);
+        return n;
+    }
+
+    if (index == METRIC_STAGE_COUNT + 3) {
+        HeapSample heap = sampleHeap();
+        unsigned fragmentation = heapFragmentation(heap);
+        SoakSummary soak = getSoakSummary();
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_heap_largest_free_block_bytes Largest allocatable block in internal RAM.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_heap_largest_free_block_bytes gauge\n");
+        n = appendf(out, size, n, "m5s3_heap_largest_free_block_bytes %lu\n", (unsigned long)heap.largest_block);
+        n = appendf(out, size, n, "# HELP m5s3_heap_fragmentation_ratio Share of free internal RAM outside the largest block.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_heap_fragmentation_ratio gauge\n");
+        n = appendf(out, size, n, "m5s3_heap_fragmentation_ratio %u.%02u\n", fragmentation / 100, fragmentation % 100);
+        if (soak.enabled) {
+            n = appendf(out, size, n, "# HELP m5s3_soak_samples_total Heap samples recorded by the soak test.\n");
+            n = appendf(out, size, n, "# TYPE m5s3_soak_samples_total counter\n");
+            n = appendf(out, size, n, "m5s3_soak_samples_total %lu\n", (unsigned long)soak.samples);
+            n = appendf(out, size, n, "# HELP m5s3_soak_heap_trend_bytes_per_hour Least-squares slope over the soak window.\n");
+            n = appendf(out, size, n, "# TYPE m5s3_soak_heap_trend_bytes_per_hour gauge\n");
+            n = appendf(out, size, n, "m5s3_soak_heap_trend_bytes_per_hour{value=\"free\"} %ld\n", (long)soak.free_trend);
+            n = appendf(out, size, n, "m5s3_soak_heap_trend_bytes_per_hour{value=\"largest_block\"} %ld\n",
+                        (long)soak.largest_trend);
+        }
+        return n;
+    }
+
+    if (index == METRIC_STAGE_COUNT + 4) {
+        ReportEmitStats emit = getReportEmitStats();
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_reports_sent_total Reports written to USB HID.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_reports_sent_total counter\n");
+        n = appendf(out, size, n, "m5s3_reports_sent_total %lu\n", (unsigned long)emit.sent);
+        n = appendf(out, size, n, "# HELP m5s3_reports_suppressed_total Reports skipped because nothing changed.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_reports_suppressed_total counter\n");
+        n = appendf(out, size, n, "m5s3_reports_suppressed_total %lu\n", (unsigned long)emit.suppressed);
+        n = appendf(out, size, n, "# HELP m5s3_reports_keepalive_total Unchanged reports resent after the keep-alive interval.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_reports_keepalive_total counter\n");
+        n = appendf(out, size, n, "m5s3_reports_keepalive_total %lu\n", (unsigned long)emit.keepalive);
+        n = appendf(out, size, n, "# HELP m5s3_report_send_seconds Average time one report send blocks, including the wait for the host poll.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_report_send_seconds gauge\n");
+        n = appendf(out, size, n, "m5s3_report_send_seconds %lu.%06lu\n",
+                    (unsigned long)(emit.avg_send_us / 1000000), (unsigned long)(emit.avg_send_us % 1000000));
+        n = appendf(out, size, n, "# HELP m5s3_report_saved_bytes_total HID bytes not sent thanks to suppression.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_report_saved_bytes_total counter\n");
+        n = appendf(out, size, n, "m5s3_report_saved_bytes_total %llu\n",
+                    (unsigned long long)emit.suppressed * SWITCH_REPORT_SIZE);
+        return n;
+    }
+
+    if (index == METRIC_STAGE_COUNT + 5) {
+        InputEdgeStats edges = getInputEdgeStats();
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_input_edges_total Press edge events queued by web and touch input.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_input_edges_total counter\n");
+        n = appendf(out, size, n, "m5s3_input_edges_total{result=\"queued\"} %lu\n", (unsigned long)edges.events);
+        n = appendf(out, size, n, "m5s3_input_edges_total{result=\"dropped\"} %lu\n", (unsigned long)edges.dropped);
+        n = appendf(out, size, n, "m5s3_input_edges_total{result=\"ignored\"} %lu\n", (unsigned long)edges.ignored);
+        n = appendf(out, size, n, "# HELP m5s3_input_presses_total Presses shown in reports from the edge queue.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_input_presses_total counter\n");
+        n = appendf(out, size, n, "m5s3_input_presses_total{result=\"shown\"} %lu\n", (unsigned long)edges.presses);
+        n = appendf(out, size, n, "m5s3_input_presses_total{result=\"stretched\"} %lu\n", (unsigned long)edges.stretched);
+        n = appendf(out, size, n, "m5s3_input_presses_total{result=\"coalesced\"} %lu\n", (unsigned long)edges.coalesced);
+        ScheduledInputStats schedule = getScheduledInputStats();
+        n = appendf(out, size, n, "# HELP m5s3_scheduled_inputs_total Inputs with a device time (at_us).\n");
+        n = appendf(out, size, n, "# TYPE m5s3_scheduled_inputs_total counter\n");
+        n = appendf(out, size, n, "m5s3_scheduled_inputs_total{result=\"applied\"} %lu\n", (unsigned long)schedule.applied);
+        n = appendf(out, size, n, "m5s3_scheduled_inputs_total{result=\"late\"} %lu\n", (unsigned long)schedule.late);
+        n = appendf(out, size, n, "m5s3_scheduled_inputs_total{result=\"rejected\"} %lu\n", (unsigned long)schedule.rejected);
+        return n;
+    }
+
+    if (index == METRIC_STAGE_COUNT + 6) {
+        StickJitterStats jitter = getStickJitterStats();
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_stick_jitter_depth_seconds Playout delay of the stick jitter buffer.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_stick_jitter_depth_seconds gauge\n");
+        n = appendf(out, size, n, "m5s3_stick_jitter_depth_seconds %lu.%03lu\n",
+                    (unsigned long)(jitter.depth_ms / 1000), (unsigned long)(jitter.depth_ms % 1000));
+        n = appendf(out, size, n, "# HELP m5s3_stick_jitter_buffered Stick samples waiting in the jitter buffer.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_stick_jitter_buffered gauge\n");
+        n = appendf(out, size, n, "m5s3_stick_jitter_buffered %lu\n", (unsigned long)jitter.buffered);
+        n = appendf(out, size, n, "# HELP m5s3_stick_jitter_samples_total Stick samples by outcome.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_stick_jitter_samples_total counter\n");
+        n = appendf(out, size, n, "m5s3_stick_jitter_samples_total{result=\"buffered\"} %lu\n", (unsigned long)jitter.samples);
+        n = appendf(out, size, n, "m5s3_stick_jitter_samples_total{result=\"late\"} %lu\n", (unsigned long)jitter.late);
+        n = appendf(out, size, n, "m5s3_stick_jitter_samples_total{result=\"overflow\"} %lu\n", (unsigned long)jitter.overflow);
+        n = appendf(out, size, n, "# HELP m5s3_stick_jitter_underruns_total Report cycles that held the last stick value.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_stick_jitter_underruns_total counter\n");
+        n = appendf(out, size, n, "m5s3_stick_jitter_underruns_total %lu\n", (unsigned long)jitter.underruns);
+        return n;
+    }
+
+    if (index == METRIC_STAGE_COUNT + 7) {
+        UsbPollSyncStats poll = getUsbPollSyncStats();
+        size_t n = 0;
+        n = appendf(out, size, n, "# HELP m5s3_usb_poll_locked Whether report emission is aligned to predicted host polls.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_usb_poll_locked gauge\n");
+        n = appendf(out, size, n, "m5s3_usb_poll_locked %d\n", poll.locked ? 1 : 0);
+        n = appendf(out, size, n, "# HELP m5s3_usb_poll_phase_error_seconds Average distance between IN completions and predicted polls.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_usb_poll_phase_error_seconds gauge\n");
+        n = appendf(out, size, n, "m5s3_usb_poll_phase_error_seconds %lu.%06lu\n",
+                    (unsigned long)(poll.avg_abs_error_us / 1000000), (unsigned long)(poll.avg_abs_error_us % 1000000));
+        n = appendf(out, size, n, "# HELP m5s3_usb_poll_wait_seconds Average time a report waited for the host poll.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_usb_poll_wait_seconds gauge\n");
+        n = appendf(out, size, n, "m5s3_usb_poll_wait_seconds %lu.%06lu\n",
+                    (unsigned long)(poll.avg_wait_us / 1000000), (unsigned long)(poll.avg_wait_us % 1000000));
+        n = appendf(out, size, n, "# HELP m5s3_usb_poll_drift_ppm Estimated host poll interval offset from the nominal value.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_usb_poll_drift_ppm gauge\n");
+        n = appendf(out, size, n, "m5s3_usb_poll_drift_ppm %ld\n", (long)poll.drift_ppm);
+        n = appendf(out, size, n, "# HELP m5s3_usb_poll_relocks_total Times the poll prediction was reacquired.\n");
+        n = appendf(out, size, n, "# TYPE m5s3_usb_poll_relocks_total counter\n");
+        n = appendf(out, size, n, "m5s3_usb_poll_relocks_total %lu\n", (unsigned long)poll.relocks);
+        return n;
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "types.h"
+
+// 計測区間（ヒストグラム単位）
+enum MetricStage : uint8_t {
+    METRIC_HTTP_RECEIVE = 0,   // リクエスト先頭の受信→本文受信完了（WebServerはhandleClient()開始→POSTハンドラー開始）
+    METRIC_HTTP_PARSE,         // POSTハンドラー開始→JSON解析・状態公開
+    METRIC_INPUT_APPLY,        // 状態公開→updateWebInput()で反映
+    METRIC_REPORT_EMIT,        // 状態公開→レポート送信
+    METRIC_LOOP,               // loop()1周の処理時間（delayを除く）
+    METRIC_HANDLE_CLIENT,      // server.handleClient()
+    METRIC_DISPLAY,            // 画面描画
+    METRIC_STAGE_COUNT
+};
+
+// ヒストグラムのバケット数（上限us、最後は+Inf）
+#define METRIC_BUCKET_COUNT 12
+
+// /metrics出力の1区切り分のバッファサイズ
+#define METRICS_SECTION_SIZE 1536
+
+/**
+ * 計測用タイムスタンプ（CPUサイクルカウンタ）
+ */
+uint32_t metricsStamp();
+
+/**
+ * startからの経過時間を区間のヒストグラムに記録
+ */
+void recordStage(MetricStage stage, uint32_t start);
+
+/**
+ * 入力状態の公開時刻を記録（反映・送信までの遅延計測用）
+ */
+void markInputPublished(uint32_t stamp);
+
+/**
+ * 公開済み入力がupdateWebInput()で反映された時点で呼ぶ
+ */
+void recordInputApplied();
+
+/**
+ * レポート送信後に呼ぶ（公開済み入力があれば送信までの遅延を記録）
+ */
+void recordReportEmitted();
+
+/**
+ * /metrics出力（Prometheusテキスト形式）のindex番目の区切りを書き出し
+ * 書き込んだ文字数を返す（全て出力済みなら0）
+ */
+size_t formatMetricsSection(size_t index, char *out, size_t size);
+
+#endif // METRICS_H
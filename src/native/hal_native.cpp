@@ -0,0 +1,93 @@
+#include "hal_native.h"
+#include <stdio.h>
+#include <time.h>
+#include <mutex>
+
+// 起動時刻（halMillis/halMicrosの基準）
+static int64_t monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static const int64_t startMicros = monotonicMicros();
+
+// HID出力（実機のUSBの代わりにレポートを記録）
+static FILE *hidLog = nullptr;
+static SwitchReport lastReport;
+static NativeHidStats hidStats;
+static std::mutex hidMutex;
+
+// 模擬するホストのポーリング（最初のポーリング時刻と間隔、間隔はns）
+static int64_t pollStartMicros = 0;
+static double pollIntervalNs = 0.0;
+
+uint32_t halMillis() {
+    return (uint32_t)(halMicros() / 1000);
+}
+
+int64_t halMicros() {
+    return monotonicMicros() - startMicros;
+}
+
+// 次の模擬ポーリングまで待つ（実機のIN転送の完了待ちに相当）
+static void waitForUsbPoll() {
+    if (pollIntervalNs <= 0.0) return;
+
+    int64_t now = monotonicMicros();
+    int64_t polls = (int64_t)((now - pollStartMicros) * 1000.0 / pollIntervalNs) + 1;
+    int64_t pollNs = pollStartMicros * 1000 + (int64_t)(polls * pollIntervalNs);
+    struct timespec ts;
+    ts.tv_sec = pollNs / 1000000000;
+    ts.tv_nsec = pollNs % 1000000000;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+}
+
+void halSendReport(const SwitchReport &report) {
+    waitForUsbPoll();
+
+    // 記録はCLOCK_MONOTONICの絶対時刻（負荷生成側の送信時刻と比較するため）
+    int64_t now = monotonicMicros();
+
+    std::lock_guard<std::mutex> lock(hidMutex);
+    hidStats.reports++;
+    if (hidStats.reports > 1 && report == lastReport) return;
+
+    hidStats.changes++;
+    lastReport = report;
+    if (hidLog != nullptr) {
+        fprintf(hidLog, "%lld,%llu,%u,%u,%u,%u,%u,%u\n",
+                (long long)now,
+                (unsigned long long)hidStats.reports,
+                report.buttons, report.hat, report.lx, report.ly, report.rx, report.ry);
+    }
+}
+
+bool openNativeHidLog(const char *path) {
+    std::lock_guard<std::mutex> lock(hidMutex);
+    if (path == nullptr) return true;
+
+    hidLog = fopen(path, "w");
+    if (hidLog == nullptr) return false;
+    fprintf(hidLog, "mono_us,report,buttons,hat,lx,ly,rx,ry\n");
+    return true;
+}
+
+void closeNativeHidLog() {
+    std::lock_guard<std::mutex> lock(hidMutex);
+    if (hidLog != nullptr) {
+        fclose(hidLog);
+        hidLog = nullptr;
+    }
+}
+
+void setNativeUsbPoll(uint32_t interval_us, int32_t ppm) {
+    // デバイスの周期と揃わないよう位相をずらして開始
+    pollStartMicros = monotonicMicros() + interval_us * 3 / 8;
+    pollIntervalNs = interval_us * 1000.0 * (1.0 + ppm / 1000000.0);
+}
+
+NativeHidStats getNativeHidStats() {
+    std::lock_guard<std::mutex> lock(hidMutex);
+    return hidStats;
+}
@@ -0,0 +1,34 @@
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+#include <stdint.h>
+#include "hal.h"
+
+// Linux用HID出力の統計
+struct NativeHidStats {
+    uint64_t reports = 0;      // 送信したレポート数
+    uint64_t changes = 0;      // 前回から内容が変わったレポート数
+};
+
+/**
+ * HID出力の記録先を開く（変化したレポートをCLOCK_MONOTONIC時刻付きのCSVで記録、nullptrで記録なし）
+ */
+bool openNativeHidLog(const char *path);
+
+/**
+ * HID出力の記録を閉じる
+ */
+void closeNativeHidLog();
+
+/**
+ * ホストのUSBポーリングを模擬（halSendReport()が次のポーリング時刻まで待つ）
+ * interval_us=0なら待たない。ppmはデバイスの時計に対するポーリング間隔のずれ
+ */
+void setNativeUsbPoll(uint32_t interval_us, int32_t ppm);
+
+/**
+ * HID出力の統計を取得
+ */
+NativeHidStats getNativeHidStats();
+
+#endif // HAL_NATIVE_H
@@ -0,0 +1,270 @@
+// Linux上で入力処理（HTTP/UDP受信 → 状態公開 → レポート送信）を動かすエントリーポイント
+// 実機のWiFi/USB/画面の代わりにソケットとhal_native.cppのHID記録を使用する
+//
+//   pio run -e native
+//   .pio/build/native/program --http-port 8080 --hid-log hid.csv [--turbo A,10,50] [--usb-poll-us 8000 --usb-poll-ppm 200]
+#include "hal_native.h"
+#include "input_ingest.h"
+#include "input_frame.h"
+#include "report_cycle.h"
+#include "input_edges.h"
+#include "input_clock.h"
+#include "stick_curve.h"
+#include "turbo.h"
+#include "usb_poll_sync.h"
+#include "http_request.h"
+#include "env.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+#define NATIVE_MAX_CLIENTS 16
+#define NATIVE_HTTP_BUFFER 8192
+
+static std::atomic<bool> running{true};
+
+// HTTP接続ごとの受信バッファ
+struct HttpClient {
+    int fd = -1;
+    size_t length = 0;
+    char buffer[NATIVE_HTTP_BUFFER];
+};
+
+static HttpClient clients[NATIVE_MAX_CLIENTS];
+static FrameReceiver udpReceiver;
+static FrameSender udpSenders[UDP_MAX_SENDERS];
+
+static const char REPLY_NOT_FOUND[] = "{\"error\":\"Not found\"}";
+
+static void onSignal(int) {
+    running.store(false);
+}
+
+// レポート送信（デバイスのレポート送信タスクと同じ周期、ポーリングに同期していればその直前に起床）
+static void reportThread() {
+    int64_t wake = halMicros();
+    while (running.load()) {
+        wake = nextReportWake(wake);
+        int64_t delay = wake - halMicros();
+        if (delay > 0) {
+            struct timespec ts = {(time_t)(delay / 1000000), (long)(delay % 1000000) * 1000};
+            nanosleep(&ts, nullptr);
+        } else if (delay < -REPORT_INTERVAL_MS * 1000) {
+            wake = halMicros();   // 1周期以上遅れたら追いつこうとせず今から
+        }
+
+        // タッチ入力・タイムラインなし（ニュートラル）
+        runReportCycle(false);
+    }
+}
+
+static int openSocket(int type, int port) {
+    int fd = socket(AF_INET, type, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        (type == SOCK_STREAM && listen(fd, NATIVE_MAX_CLIENTS) < 0)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void sendResponse(int fd, int code, const char *body, size_t length, bool keepAlive) {
+    char header[192];
+    size_t n = formatHttpResponseHead(header, sizeof(header), code, "application/json", length, keepAlive);
+    send(fd, header, n, MSG_NOSIGNAL);
+    send(fd, body, length, MSG_NOSIGNAL);
+}
+
+// POST /controller（デバイスと共通のprocessControllerBody()）
+static void handleControllerBody(int fd, const char *body, size_t length, bool keepAlive) {
+    char buffer[CONTROLLER_REPLY_SIZE];
+    const char *reply;
+    size_t replyLength;
+    int code = processControllerBody(body, length, buffer, sizeof(buffer), reply, replyLength);
+    sendResponse(fd, code, reply, replyLength, keepAlive);
+}
+
+// 受信済みのリクエストを全て処理（接続を閉じる場合false）
+static bool processRequests(HttpClient &client) {
+    for (;;) {
+        HttpRequest request;
+        HttpParseResult result = parseHttpRequest(client.buffer, client.length, NATIVE_HTTP_BUFFER, request);
+        if (result == HTTP_PARSE_INCOMPLETE) return true;
+        if (result != HTTP_PARSE_OK) return false;
+
+        if (httpRequestIs(request, "POST", "/controller")) {
+            handleControllerBody(client.fd, request.body, request.body_length, request.keep_alive);
+        } else if (httpRequestIs(request, "GET", "/time")) {
+            char json[160];
+            size_t length = formatClockSync(json, sizeof(json), halMicros());
+            sendResponse(client.fd, 200, json, length, request.keep_alive);
+        } else {
+            sendResponse(client.fd, 404, REPLY_NOT_FOUND, sizeof(REPLY_NOT_FOUND) - 1, request.keep_alive);
+        }
+        if (!request.keep_alive) return false;
+
+        // 処理済みのリクエストを詰める（パイプライン対応）
+        memmove(client.buffer, client.buffer + request.total, client.length - request.total);
+        client.length -= request.total;
+    }
+}
+
+static void acceptClient(int listenFd) {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+
+    for (HttpClient &client : clients) {
+        if (client.fd < 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            client.fd = fd;
+            client.length = 0;
+            return;
+        }
+    }
+    close(fd);
+}
+
+static void readClient(HttpClient &client) {
+    ssize_t n = recv(client.fd, client.buffer + client.length, NATIVE_HTTP_BUFFER - client.length, 0);
+    if (n > 0) {
+        client.length += n;
+        if (processRequests(client)) return;
+    } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    close(client.fd);
+    client.fd = -1;
+}
+
+static void readUdp(int fd) {
+    uint8_t buffer[sizeof(UdpFrameHeader) + sizeof(UdpFrameState) * UDP_MAX_STATES];
+    struct sockaddr_in from;
+    socklen_t fromLength = sizeof(from);
+    ssize_t n;
+    while ((n = recvfrom(fd, buffer, sizeof(buffer), MSG_DONTWAIT, (struct sockaddr *)&from, &fromLength)) > 0) {
+        FrameSequence &sequence = findFrameSender(udpSenders, UDP_MAX_SENDERS,
+                                                  from.sin_addr.s_addr, ntohs(from.sin_port));
+        lockWebInput();
+        applyInputFrame(udpReceiver, sequence, buffer, (int)n, halMillis());
+        unlockWebInput();
+        fromLength = sizeof(from);
+    }
+}
+
+int main(int argc, char **argv) {
+    int httpPort = 8080;
+    int udpPort = UDP_INPUT_PORT;
+    const char *hidLogPath = nullptr;
+    const char *turboArg = nullptr;   // 連打（ボタン名,回/秒,押下の割合%）
+    int pollUs = 0;                   // 模擬するホストのポーリング間隔（us、0なら待たない）
+    int pollPpm = 0;                  // ポーリング間隔のずれ（ppm）
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--http-port") == 0) httpPort = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--udp-port") == 0) udpPort = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--hid-log") == 0) hidLogPath = argv[i + 1];
+        else if (strcmp(argv[i], "--turbo") == 0) turboArg = argv[i + 1];
+        else if (strcmp(argv[i], "--usb-poll-us") == 0) pollUs = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--usb-poll-ppm") == 0) pollPpm = atoi(argv[i + 1]);
+    }
+
+    initStickCurves();
+    if (turboArg != nullptr) {
+        char name[16] = "";
+        float hz = 0.0f;
+        int duty = 50;
+        if (sscanf(turboArg, "%15[^,],%f,%d", name, &hz, &duty) < 2 ||
+            !startTurbo(findTurboButton(name), hz, (uint8_t)duty)) {
+            fprintf(stderr, "invalid --turbo (NAME,HZ[,DUTY])\n");
+            return 1;
+        }
+    }
+
+    setNativeUsbPoll(pollUs > 0 ? pollUs : 0, pollPpm);
+
+    int httpFd = openSocket(SOCK_STREAM, httpPort);
+    int udpFd = openSocket(SOCK_DGRAM, udpPort);
+    if (httpFd < 0 || udpFd < 0 || !openNativeHidLog(hidLogPath)) {
+        fprintf(stderr, "failed to open sockets or HID log\n");
+        return 1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    printf("HTTP :%d  UDP :%d  report interval %d ms\n", httpPort, udpPort, REPORT_INTERVAL_MS);
+
+    std::thread reporter(reportThread);
+
+    struct pollfd fds[NATIVE_MAX_CLIENTS + 2];
+    while (running.load()) {
+        fds[0] = {httpFd, POLLIN, 0};
+        fds[1] = {udpFd, POLLIN, 0};
+        for (int i = 0; i < NATIVE_MAX_CLIENTS; i++) {
+            fds[i + 2] = {clients[i].fd, POLLIN, 0};
+        }
+
+        if (poll(fds, NATIVE_MAX_CLIENTS + 2, 100) <= 0) continue;
+
+        if (fds[0].revents & POLLIN) acceptClient(httpFd);
+        if (fds[1].revents & POLLIN) readUdp(udpFd);
+        for (int i = 0; i < NATIVE_MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0 && (fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR))) {
+                readClient(clients[i]);
+            }
+        }
+    }
+
+    reporter.join();
+    closeNativeHidLog();
+
+    NativeHidStats stats = getNativeHidStats();
+    ReportEmitStats emit = getReportEmitStats();
+    InputEdgeStats edges = getInputEdgeStats();
+    printf("reports %llu  changes %llu  suppressed %lu  taps stretched %lu  coalesced %lu  dropped %lu  "
+           "button presses %d  udp applied %lu\n",
+           (unsigned long long)stats.reports,
+           (unsigned long long)stats.changes,
+           (unsigned long)emit.suppressed,
+           (unsigned long)edges.stretched,
+           (unsigned long)edges.coalesced,
+           (unsigned long)edges.dropped,
+           button_press_count,
+           (unsigned long)udpReceiver.stats.applied);
+
+    if (pollUs > 0) {
+        UsbPollSyncStats sync = getUsbPollSyncStats();
+        printf("usb poll  locked %s  samples %lu  ignored %lu  relocks %lu  phase error avg %lu us  max %lu us  "
+               "wait avg %lu us  drift %ld ppm\n",
+               sync.locked ? "yes" : "no",
+               (unsigned long)sync.samples,
+               (unsigned long)sync.ignored,
+               (unsigned long)sync.relocks,
+               (unsigned long)sync.avg_abs_error_us,
+               (unsigned long)sync.max_abs_error_us,
+               (unsigned long)sync.avg_wait_us,
+               (long)sync.drift_ppm);
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "report_cycle.h"
+#include "report_pipeline.h"
+#include "controller_state.h"
+#include "input_edges.h"
+#include "input_clock.h"
+#include "stick_jitter.h"
+#include "turbo.h"
+#include "hal.h"
+
+// 入力元ごとの最新スナップショット（読み出し失敗時は前回値を使用、レポート送信側のみ使用）
+static ControllerState webSnapshot;
+static ControllerState touchSnapshot;
+static ControllerState timelineSnapshot;
+
+bool runReportCycle(bool timelineActive) {
+    // 時刻指定入力のうちこの周期が最も近いものを先に公開
+    applyScheduledInputs(halMicros());
+
+    webInput.read(webSnapshot);
+    touchInput.read(touchSnapshot);
+
+    // スティックの受信ストリームはジッターバッファから周期ごとに再生
+    uint32_t now = halMillis();
+    playoutSticks(webSnapshot, now);
+
+    // タイムライン再生中はWeb入力の代わりにタイムラインの状態を使用（押下エッジも同じ入力元のみ）
+    const ControllerState *remote = &webSnapshot;
+    uint32_t sources = INPUT_SOURCE_BIT(INPUT_SOURCE_WEB) | INPUT_SOURCE_BIT(INPUT_SOURCE_TOUCH);
+    if (timelineActive) {
+        timelineInput.read(timelineSnapshot);
+        remote = &timelineSnapshot;
+        sources = INPUT_SOURCE_BIT(INPUT_SOURCE_TIMELINE) | INPUT_SOURCE_BIT(INPUT_SOURCE_TOUCH);
+    }
+
+    // 押下/解放は入力レベルに従い、周期の間に押して離されたボタンは押下エッジから補う
+    SwitchReport report = mergeSwitchReport(*remote, touchSnapshot);
+    applyPressedEdges(report, now, sources);
+    // 連打はこのレポートの周期番号で押下/解放を決める
+    applyTurbo(report, getReportFrame() + 1);
+    return emitSwitchReport(report);
+}
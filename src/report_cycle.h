@@ -0,0 +1,14 @@
+#ifndef REPORT_CYCLE_H
+#define REPORT_CYCLE_H
+
+#include "switch_report.h"
+
+/**
+ * 1周期分のレポートを作成して送信（レポート送信タスク/nativeのレポートスレッド共通）
+ * 時刻指定入力の公開 → 各入力の読み出し → スティックの再生 → 合成 → 押下エッジ → 連打 → 送信
+ * timelineActive: タイムライン再生中はWeb入力の代わりにタイムラインの状態を使用
+ * 送信した場合はtrue（変化なしで抑制した場合はfalse）
+ */
+bool runReportCycle(bool timelineActive);
+
+#endif // REPORT_CYCLE_H
@@ -0,0 +1,134 @@
+#include "report_pipeline.h"
+#include "stick_curve.h"
+#include "usb_poll_sync.h"
+#include "hal.h"
+#include "env.h"
+
+int button_press_count = 0;
+
+// 最後に送信したレポート（変化検出・押下回数カウント用、レポート送信側のみ使用）
+static SwitchReport lastSentReport;
+static uint32_t lastSendTime = 0;
+static bool hasSent = false;
+
+// レポート周期の番号（フレーム番号）
+static std::atomic<uint32_t> reportFrame{0};
+
+// 直近のレポート周期（レポート送信側のみ書き込み、読み出しはseqlock）
+static std::atomic<uint32_t> cycleSequence{0};
+static ReportCycle lastCycle;
+
+// 送信・抑制の統計（他タスクから読み出し）
+static std::atomic<uint32_t> reportsSent{0};
+static std::atomic<uint32_t> reportsSuppressed{0};
+static std::atomic<uint32_t> reportsKeepalive{0};
+static std::atomic<uint32_t> sendTimeAvg16{0};
+static std::atomic<uint32_t> sendTimeMax{0};
+
+SwitchReport mergeSwitchReport(const ControllerState &remote, const ControllerState &touch) {
+    SwitchReport report;
+
+    // タッチ入力またはWeb入力で押下判定（入力レベルをそのまま反映）
+    report.buttons = remote.buttons | touch.buttons;
+    report.hat = remote.hat;
+
+    // 左スティック
+    // Web入力がある場合は精密制御、ない場合はタッチ入力
+    const ControllerState &lstick =
+        (remote.lstick_x != 0 || remote.lstick_y != 0) ? remote : touch;
+    // 応答カーブ・デッドゾーンを適用（Y軸の反転も含む）
+    stickToReportCurve(STICK_LEFT, lstick.lstick_x * STICK_UNITS_PER_PERCENT,
+                       lstick.lstick_y * STICK_UNITS_PER_PERCENT, report.lx, report.ly);
+
+    // 右スティック（Web入力のみ）
+    stickToReportCurve(STICK_RIGHT, remote.rstick_x * STICK_UNITS_PER_PERCENT,
+                       remote.rstick_y * STICK_UNITS_PER_PERCENT, report.rx, report.ry);
+
+    return report;
+}
+
+// halSendReport()の所要時間を記録（IN転送完了までの待ちを含む。平均は1/16の指数移動平均、us×16で保持）
+static void recordSendTime(uint32_t us) {
+    uint32_t avg16 = sendTimeAvg16.load(std::memory_order_relaxed);
+    avg16 = avg16 == 0 ? us * 16 : avg16 - avg16 / 16 + us;
+    sendTimeAvg16.store(avg16, std::memory_order_relaxed);
+    if (us > sendTimeMax.load(std::memory_order_relaxed)) {
+        sendTimeMax.store(us, std::memory_order_relaxed);
+    }
+}
+
+bool emitSwitchReport(const SwitchReport &report) {
+    int64_t cycleUs = halMicros();
+    uint32_t now = (uint32_t)(cycleUs / 1000);
+    bool changed = !hasSent || report != lastSentReport;
+    bool keepalive = !changed && now - lastSendTime >= REPORT_KEEPALIVE_MS;
+    uint32_t frame = reportFrame.fetch_add(1, std::memory_order_release) + 1;
+
+    uint32_t seq = cycleSequence.load(std::memory_order_relaxed);
+    cycleSequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    lastCycle.frame = frame;
+    lastCycle.time_us = cycleUs;
+    cycleSequence.store(seq + 2, std::memory_order_release);
+
+    // 変化がなくキープアライブ前なら送信しない（HIDは前回のレポートを保持）
+    if (!changed && !keepalive) {
+        reportsSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    button_press_count += countPressedEdges(lastSentReport.buttons, report.buttons);
+
+    int64_t start = halMicros();
+    halSendReport(report);
+    int64_t complete = halMicros();
+    recordSendTime((uint32_t)(complete - start));
+    recordUsbPollComplete(start, complete);
+
+    lastSentReport = report;
+    lastSendTime = now;
+    hasSent = true;
+    reportsSent.fetch_add(1, std::memory_order_relaxed);
+    if (keepalive) reportsKeepalive.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint32_t getReportFrame() {
+    return reportFrame.load(std::memory_order_acquire);
+}
+
+ReportCycle getLastReportCycle() {
+    ReportCycle cycle;
+    for (;;) {
+        uint32_t before = cycleSequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        cycle = lastCycle;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (cycleSequence.load(std::memory_order_relaxed) == before) return cycle;
+    }
+}
+
+ReportCycle predictReportCycle(int64_t at_us) {
+    const int64_t interval = REPORT_INTERVAL_MS * 1000;
+    ReportCycle last = getLastReportCycle();
+
+    // 最も近い周期（半周期で丸め）。直近の周期以前なら次の周期
+    int64_t ahead = at_us - last.time_us + interval / 2;
+    int64_t cycles = ahead > 0 ? ahead / interval : 0;
+    if (cycles < 1) cycles = 1;
+
+    ReportCycle predicted;
+    predicted.frame = last.frame + (uint32_t)cycles;
+    predicted.time_us = last.time_us + cycles * interval;
+    return predicted;
+}
+
+ReportEmitStats getReportEmitStats() {
+    ReportEmitStats stats;
+    stats.sent = reportsSent.load(std::memory_order_relaxed);
+    stats.suppressed = reportsSuppressed.load(std::memory_order_relaxed);
+    stats.keepalive = reportsKeepalive.load(std::memory_order_relaxed);
+    stats.avg_send_us = sendTimeAvg16.load(std::memory_order_relaxed) / 16;
+    stats.max_send_us = sendTimeMax.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,57 @@
+#ifndef REPORT_PIPELINE_H
+#define REPORT_PIPELINE_H
+
+#include <stdint.h>
+#include "switch_report.h"
+#include "controller_state.h"
+
+// ボタン押下回数（送信したレポートの押下エッジ数）
+extern int button_press_count;
+
+// レポート送信・抑制の統計
+struct ReportEmitStats {
+    uint32_t sent = 0;             // HIDへ送信したレポート数
+    uint32_t suppressed = 0;       // 前回送信と同じため送信しなかったレポート数
+    uint32_t keepalive = 0;        // 変化なしでもREPORT_KEEPALIVE_MS経過で送信した数（sentの内数）
+    uint32_t avg_send_us = 0;      // halSendReport()1回の平均時間（us、指数移動平均、ポーリング待ちを含む）
+    uint32_t max_send_us = 0;      // halSendReport()1回の最大時間（us、ポーリング待ちを含む）
+};
+
+// レポート周期の番号と送信時刻（時刻同期・時刻指定入力用）
+struct ReportCycle {
+    uint32_t frame = 0;            // レポート周期の番号（getReportFrame()）
+    int64_t time_us = 0;           // 周期の時刻（halMicros()、us）
+};
+
+/**
+ * リモート入力（Web/UDP/WebSocket/タイムライン）とタッチ入力から1フレーム分のレポートを作成
+ */
+SwitchReport mergeSwitchReport(const ControllerState &remote, const ControllerState &touch);
+
+/**
+ * 前回送信したレポートから変化があるか、REPORT_KEEPALIVE_MS経過していればHIDへ送信
+ * 押下回数・フレーム番号を更新し、送信した場合はtrue
+ */
+bool emitSwitchReport(const SwitchReport &report);
+
+/**
+ * レポート周期の番号（送信・抑制したレポートの合計）を取得
+ */
+uint32_t getReportFrame();
+
+/**
+ * 直近のレポート周期（番号・時刻）を取得
+ */
+ReportCycle getLastReportCycle();
+
+/**
+ * 時刻at_us（halMicros()基準）に最も近い今後のレポート周期を予測（過去の時刻なら次の周期）
+ */
+ReportCycle predictReportCycle(int64_t at_us);
+
+/**
+ * レポート送信・抑制の統計を取得
+ */
+ReportEmitStats getReportEmitStats();
+
+#endif // REPORT_PIPELINE_H
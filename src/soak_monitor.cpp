@@ -0,0 +1,104 @@
+#include "soak_monitor.h"
+#include "env.h"
+#include <esp_heap_caps.h>
+
+// 内部RAMのヒープ（String等の小さな確保先）
+#define SOAK_HEAP_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+// CSVの1区切りに書き出すサンプル数
+#define SOAK_ROWS_PER_SECTION 16
+
+// 記録（リングバッファ、loop()からのみ読み書き）。無効時は領域を確保しない
+static HeapSample samples[ENABLE_SOAK_TEST ? SOAK_SAMPLE_COUNT : 1];
+static const size_t SAMPLE_CAPACITY = sizeof(samples) / sizeof(samples[0]);
+static uint32_t sampleCount = 0;
+static uint32_t lastSampleTime = 0;
+
+HeapSample sampleHeap() {
+    HeapSample sample;
+    sample.uptime_s = millis() / 1000;
+    sample.free_bytes = heap_caps_get_free_size(SOAK_HEAP_CAPS);
+    sample.largest_block = heap_caps_get_largest_free_block(SOAK_HEAP_CAPS);
+    sample.min_free_bytes = heap_caps_get_minimum_free_size(SOAK_HEAP_CAPS);
+    return sample;
+}
+
+uint8_t heapFragmentation(const HeapSample &sample) {
+    if (sample.free_bytes == 0) return 0;
+    return (uint8_t)(100 - (uint64_t)sample.largest_block * 100 / sample.free_bytes);
+}
+
+void updateSoakMonitor() {
+    if (!ENABLE_SOAK_TEST) return;
+    
+    // 起動直後に1回、以降は記録間隔ごと
+    uint32_t now = millis();
+    if (sampleCount > 0 && now - lastSampleTime < SOAK_SAMPLE_INTERVAL_MS) return;
+    lastSampleTime = now;
+    
+    samples[sampleCount % SAMPLE_CAPACITY] = sampleHeap();
+    sampleCount++;
+}
+
+// 保持しているi番目（古い順）のサンプル
+static const HeapSample &storedSample(uint32_t i) {
+    uint32_t stored = sampleCount < SAMPLE_CAPACITY ? sampleCount : SAMPLE_CAPACITY;
+    return samples[(sampleCount - stored + i) % SAMPLE_CAPACITY];
+}
+
+// 値の時間に対する傾き（byte/時、最小二乗）
+static int32_t trendPerHour(uint32_t stored, uint32_t HeapSample::*field) {
+    if (stored < 2) return 0;
+    
+    double meanT = 0, meanV = 0;
+    for (uint32_t i = 0; i < stored; i++) {
+        meanT += storedSample(i).uptime_s;
+        meanV += storedSample(i).*field;
+    }
+    meanT /= stored;
+    meanV /= stored;
+    
+    double cov = 0, var = 0;
+    for (uint32_t i = 0; i < stored; i++) {
+        double dt = storedSample(i).uptime_s - meanT;
+        cov += dt * (storedSample(i).*field - meanV);
+        var += dt * dt;
+    }
+    return var > 0 ? (int32_t)(cov / var * 3600) : 0;
+}
+
+SoakSummary getSoakSummary() {
+    SoakSummary summary;
+    summary.enabled = ENABLE_SOAK_TEST;
+    summary.samples = sampleCount;
+    summary.stored = sampleCount < SAMPLE_CAPACITY ? sampleCount : SAMPLE_CAPACITY;
+    if (summary.stored == 0) return summary;
+    
+    summary.first = storedSample(0);
+    summary.last = storedSample(summary.stored - 1);
+    summary.free_trend = trendPerHour(summary.stored, &HeapSample::free_bytes);
+    summary.largest_trend = trendPerHour(summary.stored, &HeapSample::largest_block);
+    return summary;
+}
+
+size_t formatSoakSection(size_t index, char *out, size_t size) {
+    if (index == 0) {
+        int n = snprintf(out, size, "uptime_s,free_bytes,largest_free_block,min_free_bytes,fragmentation_pct\n");
+        return n > 0 && (size_t)n < size ? n : 0;
+    }
+    
+    uint32_t stored = sampleCount < SAMPLE_CAPACITY ? sampleCount : SAMPLE_CAPACITY;
+    size_t n = 0;
+    for (uint32_t i = (index - 1) * SOAK_ROWS_PER_SECTION; i < stored && i < index * SOAK_ROWS_PER_SECTION; i++) {
+        const HeapSample &sample = storedSample(i);
+        int written = snprintf(out + n, size - n, "%lu,%lu,%lu,%lu,%u\n",
+                               (unsigned long)sample.uptime_s,
+                               (unsigned long)sample.free_bytes,
+                               (unsigned long)sample.largest_block,
+                               (unsigned long)sample.min_free_bytes,
+                               (unsigned)heapFragmentation(sample));
+        if (written <= 0 || n + written >= size) break;
+        n += written;
+    }
+    return n;
+}
@@ -0,0 +1,51 @@
+#ifndef SOAK_MONITOR_H
+#define SOAK_MONITOR_H
+
+#include "types.h"
+
+// ヒープ状態（内部RAM）の1回分の記録
+struct HeapSample {
+    uint32_t uptime_s = 0;         // 起動からの経過時間（秒）
+    uint32_t free_bytes = 0;       // 空きヒープ
+    uint32_t largest_block = 0;    // 最大連続空き領域（確保できる最大サイズ）
+    uint32_t min_free_bytes = 0;   // 起動後の最小空きヒープ
+};
+
+// 長時間稼働試験の集計
+struct SoakSummary {
+    bool enabled = false;          // ENABLE_SOAK_TEST
+    uint32_t samples = 0;          // 記録したサンプル数（累計）
+    uint32_t stored = 0;           // 保持しているサンプル数
+    HeapSample first;              // 保持している最古のサンプル
+    HeapSample last;               // 最新のサンプル
+    int32_t free_trend = 0;        // 空きヒープの傾き（byte/時、保持中のサンプルから最小二乗）
+    int32_t largest_trend = 0;     // 最大連続空き領域の傾き（byte/時）
+};
+
+/**
+ * 現在のヒープ状態を取得
+ */
+HeapSample sampleHeap();
+
+/**
+ * 断片化率（%、空きヒープのうち最大連続空き領域に含まれない割合）
+ */
+uint8_t heapFragmentation(const HeapSample &sample);
+
+/**
+ * 記録間隔ごとにヒープ状態を記録（loop()から呼ぶ、ENABLE_SOAK_TEST時のみ動作）
+ */
+void updateSoakMonitor();
+
+/**
+ * 長時間稼働試験の集計を取得
+ */
+SoakSummary getSoakSummary();
+
+/**
+ * 記録したサンプル（CSV）のindex番目の区切りを書き出し
+ * 書き込んだ文字数を返す（全て出力済みなら0）
+ */
+size_t formatSoakSection(size_t index, char *out, size_t size);
+
+#endif // SOAK_MONITOR_H
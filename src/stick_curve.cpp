@@ -0,0 +1,159 @@
+#include "stick_curve.h"
+#include "switch_report.h"
+#include "env.h"
+#include <math.h>
+#include <string.h>
+#include <atomic>
+
+// 倒した量（内部単位）→ 出力量の表。作成中の表を読まないよう2面を切り替える
+struct StickCurve {
+    uint16_t table[STICK_CURVE_STEPS + 1];
+    bool circular;
+    bool invert_x;
+    bool invert_y;
+};
+
+static StickCurve curves[2][2];                              // [スティック][面]
+static std::atomic<const StickCurve *> activeCurve[2];       // nullptrなら未設定（線形）
+static int activeProfile[2] = {0, 0};
+
+// 切り替えの世代。レポート送信側は変換を終えた時点で読み始めに見た世代を記録し、
+// 両者が一致するまで（旧い面を読んでいる可能性がある間）は使用中でない面を書き換えない
+static std::atomic<uint32_t> curveGeneration[2];
+static std::atomic<uint32_t> readerGeneration[2];
+
+static_assert(STICK_FULL_SCALE % STICK_CURVE_STEPS == 0, "curve step must be an integer");
+#define STICK_CURVE_STEP (STICK_FULL_SCALE / STICK_CURVE_STEPS)
+
+int findStickProfile(const char *name) {
+    for (size_t i = 0; i < STICK_PROFILE_COUNT; i++) {
+        if (strcmp(STICK_PROFILES[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+// プロファイルから表を作成（浮動小数点は作成時のみ）
+static void buildCurve(const StickProfile &profile, StickCurve &curve) {
+    float deadzone = profile.deadzone / 100.0f;
+    float anti = profile.anti_deadzone / 100.0f;
+    float outer = profile.outer / 100.0f;
+    float exponent = profile.exponent / 100.0f;
+
+    for (int i = 0; i <= STICK_CURVE_STEPS; i++) {
+        float r = (float)i / STICK_CURVE_STEPS;
+        float out = 0.0f;
+        if (r > deadzone) {
+            float t = (r - deadzone) / (outer - deadzone);
+            if (t > 1.0f) t = 1.0f;
+            float c = profile.exponent == 100 ? t : powf(t, exponent);
+            out = anti + (1.0f - anti) * c;
+        }
+        curve.table[i] = (uint16_t)lroundf(out * STICK_FULL_SCALE);
+    }
+    curve.circular = profile.deadzone_type == STICK_DEADZONE_CIRCULAR;
+    curve.invert_x = profile.invert_x;
+    curve.invert_y = profile.invert_y;
+}
+
+bool isStickProfilePending(uint8_t stick) {
+    if (stick > STICK_RIGHT) return false;
+    return readerGeneration[stick].load(std::memory_order_acquire) !=
+           curveGeneration[stick].load(std::memory_order_relaxed);
+}
+
+bool setStickProfile(uint8_t stick, int profile) {
+    if (stick > STICK_RIGHT || profile < 0 || profile >= (int)STICK_PROFILE_COUNT) return false;
+    // 使用中でない面を前回の切り替え前から読み続けている可能性がある
+    if (isStickProfilePending(stick)) return false;
+
+    // 使用中でない面に作成してから切り替え（表の後に世代を進める）
+    StickCurve *next = activeCurve[stick].load(std::memory_order_acquire) == &curves[stick][0]
+                           ? &curves[stick][1] : &curves[stick][0];
+    buildCurve(STICK_PROFILES[profile], *next);
+    activeCurve[stick].store(next, std::memory_order_release);
+    curveGeneration[stick].fetch_add(1, std::memory_order_release);
+    activeProfile[stick] = profile;
+    return true;
+}
+
+void initStickCurves() {
+    int left = findStickProfile(STICK_PROFILE_LEFT);
+    int right = findStickProfile(STICK_PROFILE_RIGHT);
+    setStickProfile(STICK_LEFT, left >= 0 ? left : 0);
+    setStickProfile(STICK_RIGHT, right >= 0 ? right : 0);
+}
+
+int getStickProfile(uint8_t stick) {
+    return stick <= STICK_RIGHT ? activeProfile[stick] : -1;
+}
+
+// 表引き（区間内は線形補間）。magnitudeは0〜STICK_FULL_SCALE
+static int32_t lookup(const StickCurve &curve, int32_t magnitude) {
+    if (magnitude >= STICK_FULL_SCALE) return curve.table[STICK_CURVE_STEPS];
+    int32_t index = magnitude / STICK_CURVE_STEP;
+    int32_t frac = magnitude % STICK_CURVE_STEP;
+    int32_t a = curve.table[index];
+    return a + (curve.table[index + 1] - a) * frac / STICK_CURVE_STEP;
+}
+
+static int32_t clampUnits(int32_t value) {
+    if (value < -STICK_FULL_SCALE) return -STICK_FULL_SCALE;
+    if (value > STICK_FULL_SCALE) return STICK_FULL_SCALE;
+    return value;
+}
+
+static uint32_t isqrt(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > value) bit >>= 2;
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+// 内部単位 → HIDレポート値（stickToReport()と同じ丸め）
+static uint8_t unitsToReport(int32_t value) {
+    value = clampUnits(value);
+    if (value < 0) {
+        return (uint8_t)(SWITCH_STICK_NEUTRAL + value * SWITCH_STICK_NEUTRAL / STICK_FULL_SCALE);
+    }
+    return (uint8_t)(SWITCH_STICK_NEUTRAL + value * (255 - SWITCH_STICK_NEUTRAL) / STICK_FULL_SCALE);
+}
+
+void stickToReportCurve(uint8_t stick, int32_t x, int32_t y, uint8_t &reportX, uint8_t &reportY) {
+    x = clampUnits(x);
+    y = clampUnits(y);
+
+    // 世代を先に読む（この世代以降の表を使うため、変換後に記録すれば旧い面を読んでいないことを示せる）
+    bool valid = stick <= STICK_RIGHT;
+    uint32_t generation = valid ? curveGeneration[stick].load(std::memory_order_acquire) : 0;
+    const StickCurve *curve = valid ? activeCurve[stick].load(std::memory_order_acquire) : nullptr;
+    if (curve != nullptr) {
+        if (curve->circular) {
+            // 半径を変換し、方向はそのまま
+            int32_t magnitude = (int32_t)isqrt((uint32_t)(x * x + y * y));
+            if (magnitude > 0) {
+                int32_t out = lookup(*curve, magnitude);
+                x = (int32_t)((int64_t)x * out / magnitude);
+                y = (int32_t)((int64_t)y * out / magnitude);
+            }
+        } else {
+            x = x < 0 ? -lookup(*curve, -x) : lookup(*curve, x);
+            y = y < 0 ? -lookup(*curve, -y) : lookup(*curve, y);
+        }
+        if (curve->invert_x) x = -x;
+        if (curve->invert_y) y = -y;
+    }
+    if (valid) readerGeneration[stick].store(generation, std::memory_order_release);
+
+    // 入力はY軸上向きが正のため反転
+    reportX = unitsToReport(x);
+    reportY = unitsToReport(-y);
+}
@@ -0,0 +1,74 @@
+#ifndef STICK_CURVE_H
+#define STICK_CURVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "button_table.h"
+
+// スティック変換の内部単位（100% = STICK_FULL_SCALE、入力の-100〜100は×STICK_UNITS_PER_PERCENT）
+#define STICK_UNITS_PER_PERCENT 256
+#define STICK_FULL_SCALE (100 * STICK_UNITS_PER_PERCENT)
+
+// 応答カーブの表の区間数（表は区間数+1点、間は線形補間）
+#define STICK_CURVE_STEPS 256
+
+// デッドゾーンの形
+enum StickDeadzone : uint8_t {
+    STICK_DEADZONE_SQUARE = 0,   // 軸ごとに判定・変換
+    STICK_DEADZONE_CIRCULAR,     // 倒した量（半径）で判定・変換し、方向は保つ
+};
+
+// スティックの応答プロファイル
+struct StickProfile {
+    const char *name;
+    uint8_t deadzone_type;       // StickDeadzone
+    uint8_t deadzone;            // デッドゾーン（%、これ以下は0）
+    uint8_t anti_deadzone;       // アンチデッドゾーン（%、デッドゾーンを出た直後の出力）
+    uint8_t outer;               // これ以上倒すと100%（%）
+    uint16_t exponent;           // カーブの指数×100（100=線形、200=中央付近を細かく）
+    bool invert_x;
+    bool invert_y;
+};
+
+// プロファイル一覧（先頭が既定。線形は従来のstickToReport()と同じ値になる）
+static constexpr StickProfile STICK_PROFILES[] = {
+    { "linear",     STICK_DEADZONE_SQUARE,   0,  0, 100, 100, false, false },
+    { "precise",    STICK_DEADZONE_CIRCULAR, 8,  0,  95, 200, false, false },
+    { "responsive", STICK_DEADZONE_CIRCULAR, 5, 15,  95,  70, false, false },
+    { "inverted_y", STICK_DEADZONE_SQUARE,   0,  0, 100, 100, false, true  },
+};
+
+#define STICK_PROFILE_COUNT (sizeof(STICK_PROFILES) / sizeof(STICK_PROFILES[0]))
+
+/**
+ * 既定のプロファイル（STICK_PROFILE_LEFT/STICK_PROFILE_RIGHT）で表を作成
+ */
+void initStickCurves();
+
+/**
+ * プロファイルを名前で検索（見つからなければ-1）
+ */
+int findStickProfile(const char *name);
+
+/**
+ * スティック（STICK_LEFT/STICK_RIGHT）のプロファイルを切り替え（表を作り直してから切り替える、レポート送信側以外から呼ぶ）
+ * 前回の切り替え後にレポート送信側がまだ新しい表を使っていない場合は、旧い表を読んでいる可能性があるためfalse
+ */
+bool setStickProfile(uint8_t stick, int profile);
+
+/**
+ * 前回の切り替えをレポート送信側がまだ反映していないか（この間の切り替えは拒否）
+ */
+bool isStickProfilePending(uint8_t stick);
+
+/**
+ * スティックの現在のプロファイル番号
+ */
+int getStickProfile(uint8_t stick);
+
+/**
+ * 内部単位のスティック値（上が正）をプロファイルで変換してHIDレポート値（0〜255、Yは下が正）を求める
+ */
+void stickToReportCurve(uint8_t stick, int32_t x, int32_t y, uint8_t &reportX, uint8_t &reportY);
+
+#endif // STICK_CURVE_H
@@ -0,0 +1,226 @@
+#include "stick_jitter.h"
+#include "env.h"
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#endif
+
+// バッファの排他（追加は受信側、再生はレポート送信側）
+#ifdef ESP_PLATFORM
+static portMUX_TYPE jitterMux = portMUX_INITIALIZER_UNLOCKED;
+#define JITTER_LOCK() portENTER_CRITICAL(&jitterMux)
+#define JITTER_UNLOCK() portEXIT_CRITICAL(&jitterMux)
+#else
+static std::atomic_flag jitterFlag = ATOMIC_FLAG_INIT;
+#define JITTER_LOCK() while (jitterFlag.test_and_set(std::memory_order_acquire)) {}
+#define JITTER_UNLOCK() jitterFlag.clear(std::memory_order_release)
+#endif
+
+// 最小遅延（送信側とデバイスの時刻差）を求める区間のサンプル数
+#define JITTER_WINDOW_SAMPLES 64
+
+struct StickSample {
+    uint32_t seq;
+    uint32_t time_ms;          // 送信側の時刻
+    int16_t lx, ly, rx, ry;
+};
+
+// 送信側の時刻順のサンプル（先頭が最も古い）
+static StickSample jitterBuffer[ENABLE_STICK_JITTER_BUFFER ? STICK_JITTER_SAMPLES : 1];
+static uint32_t bufferedCount = 0;
+
+// 時刻差（到着 - 送信）の推定
+static bool hasTransit = false;
+static int32_t windowMin = 0;          // 現在の区間の最小値
+static int32_t previousMin = 0;        // 前の区間の最小値
+static uint32_t windowCount = 0;
+static int32_t peakExcess16 = 0;       // 最小からの遅れのピーク（ms×16、徐々に減衰）
+static int32_t interval16 = 0;         // 送信間隔（ms×16、指数移動平均）
+static uint32_t lastSeq = 0;
+static uint32_t lastTime = 0;
+static bool hasLast = false;
+static uint32_t lastArrival = 0;
+
+// 再生状態
+static bool hasPlayout = false;
+static uint32_t playoutTime = 0;       // 直近の再生位置（送信側の時刻）
+static StickSample played;             // 直近に再生した値
+static uint32_t heldCycles = 0;        // 直前の値を保持した周期数（次のサンプルが届いたらアンダーランとして確定）
+
+static StickJitterStats jitterStats;
+
+static bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static int32_t transitOffset() {
+    return windowMin < previousMin ? windowMin : previousMin;
+}
+
+// 再生遅延（固定、または最小からの遅れのピーク＋送信間隔）
+static uint32_t playoutDepth() {
+    if (STICK_JITTER_DEPTH_MS > 0) return STICK_JITTER_DEPTH_MS;
+    int32_t depth = (peakExcess16 + interval16) / 16;
+    if (depth < STICK_JITTER_MIN_MS) depth = STICK_JITTER_MIN_MS;
+    if (depth > STICK_JITTER_MAX_MS) depth = STICK_JITTER_MAX_MS;
+    return depth;
+}
+
+// 到着時刻から時刻差・送信間隔を更新（JITTER_LOCK中に呼ぶ）
+static void updateTransit(uint32_t seq, uint32_t client_ms, uint32_t arrival_ms) {
+    int32_t transit = (int32_t)(arrival_ms - client_ms);
+    if (!hasTransit || windowCount >= JITTER_WINDOW_SAMPLES) {
+        // 区間の切り替え（時計のずれに追従するため古い最小値は捨てる）
+        previousMin = hasTransit ? windowMin : transit;
+        windowMin = transit;
+        windowCount = 0;
+        hasTransit = true;
+    }
+    if (transit < windowMin) windowMin = transit;
+    windowCount++;
+
+    int32_t excess16 = (transit - transitOffset()) * 16;
+    peakExcess16 -= peakExcess16 / 256;
+    if (excess16 > peakExcess16) peakExcess16 = excess16;
+
+    // 連続したシーケンスの送信間隔
+    if (hasLast && seq == lastSeq + 1 && before(lastTime, client_ms)) {
+        int32_t delta16 = (int32_t)(client_ms - lastTime) * 16;
+        interval16 = interval16 == 0 ? delta16 : interval16 + (delta16 - interval16) / 16;
+    }
+    if (!hasLast || before(lastSeq, seq)) {
+        lastSeq = seq;
+        lastTime = client_ms;
+        hasLast = true;
+    }
+}
+
+void pushStickSample(uint32_t seq, uint32_t client_ms, const ControllerState &state, uint32_t arrival_ms) {
+    if (!ENABLE_STICK_JITTER_BUFFER) return;
+
+    StickSample sample = {seq, client_ms, state.lstick_x, state.lstick_y, state.rstick_x, state.rstick_y};
+
+    JITTER_LOCK();
+    lastArrival = arrival_ms;
+    updateTransit(seq, client_ms, arrival_ms);
+
+    // 続きのサンプルが届いたため、それまで値を保持した周期は受信中のアンダーラン
+    jitterStats.underruns += heldCycles;
+    heldCycles = 0;
+
+    if (hasPlayout && !before(playoutTime, client_ms)) {
+        // 再生位置を過ぎている
+        jitterStats.late++;
+        JITTER_UNLOCK();
+        return;
+    }
+
+    // 時刻順に挿入（同じシーケンスは重複として無視）
+    uint32_t i = bufferedCount;
+    while (i > 0 && before(client_ms, jitterBuffer[i - 1].time_ms)) i--;
+    if (i > 0 && jitterBuffer[i - 1].seq == seq) {
+        JITTER_UNLOCK();
+        return;
+    }
+    if (bufferedCount == STICK_JITTER_SAMPLES) {
+        // 満杯なら最古を破棄
+        jitterStats.overflow++;
+        if (i == 0) {
+            JITTER_UNLOCK();
+            return;
+        }
+        for (uint32_t j = 1; j < bufferedCount; j++) jitterBuffer[j - 1] = jitterBuffer[j];
+        bufferedCount--;
+        i--;
+    }
+    for (uint32_t j = bufferedCount; j > i; j--) jitterBuffer[j] = jitterBuffer[j - 1];
+    jitterBuffer[i] = sample;
+    bufferedCount++;
+    jitterStats.samples++;
+    JITTER_UNLOCK();
+}
+
+static int16_t interpolate(int16_t a, int16_t b, int32_t t, int32_t span) {
+    return (int16_t)(a + (int32_t)(b - a) * t / span);
+}
+
+// 再生位置の値を求める（JITTER_LOCK中に呼ぶ）
+static void playout(uint32_t target) {
+    // 再生位置より前のサンプルは、補間に使う直前の1つを残して捨てる
+    uint32_t drop = 0;
+    while (drop + 1 < bufferedCount && !before(target, jitterBuffer[drop + 1].time_ms)) drop++;
+    if (drop > 0) {
+        for (uint32_t j = drop; j < bufferedCount; j++) jitterBuffer[j - drop] = jitterBuffer[j];
+        bufferedCount -= drop;
+    }
+
+    const StickSample &a = jitterBuffer[0];
+    if (bufferedCount >= 2 && !before(target, a.time_ms)) {
+        // 前後のサンプルを線形補間（受信の抜けもなめらかにつなぐ）
+        const StickSample &b = jitterBuffer[1];
+        int32_t span = (int32_t)(b.time_ms - a.time_ms);
+        int32_t t = (int32_t)(target - a.time_ms);
+        played.lx = interpolate(a.lx, b.lx, t, span);
+        played.ly = interpolate(a.ly, b.ly, t, span);
+        played.rx = interpolate(a.rx, b.rx, t, span);
+        played.ry = interpolate(a.ry, b.ry, t, span);
+    } else {
+        // 先のサンプルがまだ届いていない（最初のサンプルまでは先頭の値）
+        // 送信が止まった場合は数えないよう、ここでは保留する
+        if (bufferedCount == 1 && before(a.time_ms, target)) heldCycles++;
+        played = a;
+    }
+    playoutTime = target;
+    hasPlayout = true;
+}
+
+bool playoutSticks(ControllerState &state, uint32_t now_ms) {
+    if (!ENABLE_STICK_JITTER_BUFFER) return false;
+
+    JITTER_LOCK();
+    bool active = bufferedCount > 0 && now_ms - lastArrival < STICK_JITTER_IDLE_MS;
+    if (active) {
+        // 到着時刻の最小遅延＋再生遅延だけ遅らせた送信側の時刻を再生
+        playout(now_ms - (uint32_t)transitOffset() - playoutDepth());
+        state.lstick_x = played.lx;
+        state.lstick_y = played.ly;
+        state.rstick_x = played.rx;
+        state.rstick_y = played.ry;
+    } else if (bufferedCount > 0) {
+        // 受信が途切れたら破棄（以降はwebInputの値をそのまま使う。再開時は時刻差も測り直す）
+        bufferedCount = 0;
+        heldCycles = 0;
+        hasPlayout = false;
+        hasTransit = false;
+        hasLast = false;
+        peakExcess16 = 0;
+        interval16 = 0;
+    }
+    JITTER_UNLOCK();
+    return active;
+}
+
+bool readStickPlayout(ControllerState &state) {
+    if (!ENABLE_STICK_JITTER_BUFFER) return false;
+
+    JITTER_LOCK();
+    bool active = hasPlayout;
+    if (active) {
+        state.lstick_x = played.lx;
+        state.lstick_y = played.ly;
+        state.rstick_x = played.rx;
+        state.rstick_y = played.ry;
+    }
+    JITTER_UNLOCK();
+    return active;
+}
+
+StickJitterStats getStickJitterStats() {
+    JITTER_LOCK();
+    StickJitterStats stats = jitterStats;
+    stats.enabled = ENABLE_STICK_JITTER_BUFFER;
+    stats.active = hasPlayout;
+    stats.depth_ms = hasTransit ? playoutDepth() : 0;
+    stats.buffered = bufferedCount;
+    JITTER_UNLOCK();
+    return stats;
+}
@@ -0,0 +1,41 @@
+#ifndef STICK_JITTER_H
+#define STICK_JITTER_H
+
+#include <stdint.h>
+#include "controller_state.h"
+
+// スティックのジッターバッファの統計
+struct StickJitterStats {
+    bool enabled = false;          // ENABLE_STICK_JITTER_BUFFER
+    bool active = false;           // 受信中（STICK_JITTER_IDLE_MS以内に受信あり）
+    uint32_t samples = 0;          // 受け付けたサンプル数
+    uint32_t late = 0;             // 再生位置を過ぎてから届いたため破棄した数
+    uint32_t overflow = 0;         // バッファが満杯で最古を破棄した数
+    uint32_t underruns = 0;        // 再生位置の先にサンプルがなく直前の値を保持した周期数（続きが届いた分のみ）
+    uint32_t depth_ms = 0;         // 現在の再生遅延（ms）
+    uint32_t buffered = 0;         // バッファ内のサンプル数
+};
+
+/**
+ * スティックのサンプルを追加（UDP/WebSocketバイナリ受信時、client_msは送信側の時刻）
+ * 順序違いは時刻順に並べ替え、再生位置を過ぎたものは破棄する
+ */
+void pushStickSample(uint32_t seq, uint32_t client_ms, const ControllerState &state, uint32_t arrival_ms);
+
+/**
+ * 再生位置のスティック値（前後のサンプルを線形補間）でstateのスティックを置き換え
+ * レポート送信側のみ呼ぶ。受信中でなければ何もせずfalse
+ */
+bool playoutSticks(ControllerState &state, uint32_t now_ms);
+
+/**
+ * 直近に再生したスティック値でstateのスティックを置き換え（表示用、受信中でなければfalse）
+ */
+bool readStickPlayout(ControllerState &state);
+
+/**
+ * ジッターバッファの統計を取得
+ */
+StickJitterStats getStickJitterStats();
+
+#endif // STICK_JITTER_H
@@ -0,0 +1,22 @@
+#include "switch_report.h"
+
+uint8_t stickToReport(int value) {
+    if (value < -100) value = -100;
+    if (value > 100) value = 100;
+
+    // 中央を128に固定し、負側は0まで・正側は255まで伸ばす
+    if (value < 0) {
+        return (uint8_t)(SWITCH_STICK_NEUTRAL + (value * SWITCH_STICK_NEUTRAL) / 100);
+    }
+    return (uint8_t)(SWITCH_STICK_NEUTRAL + (value * (255 - SWITCH_STICK_NEUTRAL)) / 100);
+}
+
+int countPressedEdges(uint16_t previous, uint16_t current) {
+    uint16_t pressed = current & ~previous;
+    int count = 0;
+    while (pressed) {
+        pressed &= pressed - 1;
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,65 @@
+#ifndef SWITCH_REPORT_H
+#define SWITCH_REPORT_H
+
+#include <stdint.h>
+
+// Nintendo Switch HIDレポートのボタンビット（SwitchControllerESP32のButton定義と同じ並び）
+#define SWITCH_BTN_Y        0x0001
+#define SWITCH_BTN_B        0x0002
+#define SWITCH_BTN_A        0x0004
+#define SWITCH_BTN_X        0x0008
+#define SWITCH_BTN_L        0x0010
+#define SWITCH_BTN_R        0x0020
+#define SWITCH_BTN_ZL       0x0040
+#define SWITCH_BTN_ZR       0x0080
+#define SWITCH_BTN_MINUS    0x0100
+#define SWITCH_BTN_PLUS     0x0200
+#define SWITCH_BTN_LCLICK   0x0400
+#define SWITCH_BTN_RCLICK   0x0800
+#define SWITCH_BTN_HOME     0x1000
+#define SWITCH_BTN_CAPTURE  0x2000
+
+// 十字キー（HAT）の値
+#define SWITCH_HAT_UP           0
+#define SWITCH_HAT_UP_RIGHT     1
+#define SWITCH_HAT_RIGHT        2
+#define SWITCH_HAT_DOWN_RIGHT   3
+#define SWITCH_HAT_DOWN         4
+#define SWITCH_HAT_DOWN_LEFT    5
+#define SWITCH_HAT_LEFT         6
+#define SWITCH_HAT_UP_LEFT      7
+#define SWITCH_HAT_NEUTRAL      8
+
+// スティックの中央値（HIDレポート上は0〜255）
+#define SWITCH_STICK_NEUTRAL 128
+
+// HIDレポート1回分のサイズ（ボタン2 + HAT1 + スティック4 + ベンダー1 byte）
+#define SWITCH_REPORT_SIZE 8
+
+// 1フレーム分のコントローラーレポート（全ボタン・HAT・両スティック）
+struct SwitchReport {
+    uint16_t buttons = 0;                  // SWITCH_BTN_* のビットマスク
+    uint8_t hat = SWITCH_HAT_NEUTRAL;      // SWITCH_HAT_*
+    uint8_t lx = SWITCH_STICK_NEUTRAL;     // 左スティックX（0=左, 255=右）
+    uint8_t ly = SWITCH_STICK_NEUTRAL;     // 左スティックY（0=上, 255=下）
+    uint8_t rx = SWITCH_STICK_NEUTRAL;     // 右スティックX
+    uint8_t ry = SWITCH_STICK_NEUTRAL;     // 右スティックY
+
+    bool operator==(const SwitchReport &o) const {
+        return buttons == o.buttons && hat == o.hat &&
+               lx == o.lx && ly == o.ly && rx == o.rx && ry == o.ry;
+    }
+    bool operator!=(const SwitchReport &o) const { return !(*this == o); }
+};
+
+/**
+ * スティック値（-100〜100, 負=左/上）をHIDレポート値（0〜255）に変換
+ */
+uint8_t stickToReport(int value);
+
+/**
+ * ビットマスク中の立ち上がり（新たに押されたボタン）数を数える
+ */
+int countPressedEdges(uint16_t previous, uint16_t current);
+
+#endif // SWITCH_REPORT_H
@@ -6,9 +6,20 @@
 lgfx::touch_point_t touch_point;
 bool touch_detected = false;
 
-bool isPointInButton(int x, int y, TouchButton &btn) {
-    return (x >= btn.x && x <= btn.x + btn.w && 
-            y >= btn.y && y <= btn.y + btn.h);
+bool isPointInButton(int x, int y, const TouchRect &rect) {
+    return (x >= rect.x && x <= rect.x + rect.w && 
+            y >= rect.y && y <= rect.y + rect.h);
+}
+
+void publishTouchState() {
+    ControllerState state;
+    
+    // 押されているタッチボタンをボタンビット・左スティック方向（上が正）に変換
+    for (size_t i = 0; i < TOUCH_BUTTON_COUNT; i++) {
+        if (touchButtons[i].current) setButton(state, BUTTON_TABLE[i], true);
+    }
+    
+    touchInput.publish(state);
 }
 
 void updateTouch() {
@@ -17,42 +28,18 @@ void updateTouch() {
         touch_detected = false;
         touch_point.x = 0;
         touch_point.y = 0;
-        
-        // 全ボタンのタッチ状態をfalseに
-        btnA.current = false;
-        btnB.current = false;
-        btnX.current = false;
-        btnY.current = false;
-        lstickUp.current = false;
-        lstickDown.current = false;
-        lstickLeft.current = false;
-        lstickRight.current = false;
-        btnPlus.current = false;
-        btnMinus.current = false;
-        btnHome.current = false;
-        return;
+    } else {
+        // タッチ制御有効時の処理（CoreS3のみ）
+        touch_detected = M5.Display.getTouch(&touch_point);
     }
     
-    // タッチ制御有効時の処理（CoreS3のみ）
-    // タッチ状態取得
-    touch_detected = M5.Display.getTouch(&touch_point);
-    
     // 各ボタンのタッチ状態更新
-    btnA.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, btnA);
-    btnB.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, btnB);
-    btnX.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, btnX);
-    btnY.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, btnY);
-    
-    // 左スティックのタッチ状態更新
-    lstickUp.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, lstickUp);
-    lstickDown.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, lstickDown);
-    lstickLeft.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, lstickLeft);
-    lstickRight.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, lstickRight);
+    for (size_t i = 0; i < TOUCH_BUTTON_COUNT; i++) {
+        touchButtons[i].current = touch_detected &&
+            isPointInButton(touch_point.x, touch_point.y, BUTTON_TABLE[i].touch);
+    }
     
-    // 追加ボタンのタッチ状態更新
-    btnPlus.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, btnPlus);
-    btnMinus.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, btnMinus);
-    btnHome.current = touch_detected && isPointInButton(touch_point.x, touch_point.y, btnHome);
+    publishTouchState();
 }
 
 void initTouchControl() {
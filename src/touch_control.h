@@ -15,7 +15,12 @@ void updateTouch();
 /**
  * ポイントがボタン内かチェック
  */
-bool isPointInButton(int x, int y, TouchButton &btn);
+bool isPointInButton(int x, int y, const TouchRect &rect);
+
+/**
+ * タッチ状態をコントローラー状態として公開
+ */
+void publishTouchState();
 
 /**
  * タッチ制御初期化
@@ -0,0 +1,132 @@
+#include "turbo.h"
+#include "button_table.h"
+#include "report_pipeline.h"
+#include "env.h"
+#include <stdio.h>
+#include <strings.h>
+#include <atomic>
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#endif
+
+// 設定の排他（変更は管理用Webサーバー側、参照はレポート送信側）
+#ifdef ESP_PLATFORM
+static portMUX_TYPE turboMux = portMUX_INITIALIZER_UNLOCKED;
+#define TURBO_LOCK() portENTER_CRITICAL(&turboMux)
+#define TURBO_UNLOCK() portEXIT_CRITICAL(&turboMux)
+#else
+static std::atomic_flag turboFlag = ATOMIC_FLAG_INIT;
+#define TURBO_LOCK() while (turboFlag.test_and_set(std::memory_order_acquire)) {}
+#define TURBO_UNLOCK() turboFlag.clear(std::memory_order_release)
+#endif
+
+// ボタンのビット位置ごとの設定
+static TurboSetting turboSettings[TURBO_BUTTON_COUNT];
+static std::atomic<uint16_t> turboMask{0};   // 連打中のボタン（ロックなしで空か判定）
+
+static int bitIndex(uint16_t bit) {
+    for (int i = 0; i < TURBO_BUTTON_COUNT; i++) {
+        if (bit == (1u << i)) return i;
+    }
+    return -1;
+}
+
+uint16_t findTurboButton(const char *name) {
+    for (size_t i = 0; i < BUTTON_COUNT; i++) {
+        const ButtonDescriptor &button = BUTTON_TABLE[i];
+        if (button.kind != BUTTON_KIND_BUTTON) continue;
+        // スティック押し込みのキー（press）は左右で同じため表示名（L3/R3）のみ
+        if (strcasecmp(button.name, name) == 0 ||
+            (button.id != INPUT_L3 && button.id != INPUT_R3 && strcasecmp(button.key, name) == 0)) {
+            return button.bit;
+        }
+    }
+    return 0;
+}
+
+bool startTurbo(uint16_t bit, float hz, uint8_t duty) {
+    int index = bitIndex(bit);
+    if (index < 0 || !(hz > 0.0f)) return false;
+
+    // 周期をレポート周期単位に丸める（押下・解放とも最低1レポート）
+    float period = 1000.0f / (hz * REPORT_INTERVAL_MS);
+    if (period < 1.5f || period * REPORT_INTERVAL_MS > TURBO_MAX_PERIOD_MS) return false;
+
+    TurboSetting setting;
+    setting.bit = bit;
+    setting.period = (uint16_t)(period + 0.5f);
+    int on = (int)(setting.period * (duty > 100 ? 100 : duty) / 100.0f + 0.5f);
+    if (on < 1) on = 1;
+    if (on > setting.period - 1) on = setting.period - 1;
+    setting.on = (uint16_t)on;
+    setting.start_frame = getReportFrame() + 1;
+
+    TURBO_LOCK();
+    turboSettings[index] = setting;
+    turboMask.store(turboMask.load(std::memory_order_relaxed) | bit, std::memory_order_relaxed);
+    TURBO_UNLOCK();
+    return true;
+}
+
+void stopTurbo(uint16_t bit) {
+    TURBO_LOCK();
+    turboMask.store(bit == 0 ? 0 : turboMask.load(std::memory_order_relaxed) & ~bit, std::memory_order_relaxed);
+    TURBO_UNLOCK();
+}
+
+void applyTurbo(SwitchReport &report, uint32_t frame) {
+    if (turboMask.load(std::memory_order_relaxed) == 0) return;
+
+    TURBO_LOCK();
+    uint16_t mask = turboMask.load(std::memory_order_relaxed);
+    for (int i = 0; i < TURBO_BUTTON_COUNT; i++) {
+        if (!(mask & (1u << i))) continue;
+        const TurboSetting &setting = turboSettings[i];
+        // 開始周期からの位置で押下/解放（レポートの境界と一致）
+        if ((frame - setting.start_frame) % setting.period < setting.on) {
+            report.buttons |= setting.bit;
+        } else {
+            report.buttons &= ~setting.bit;
+        }
+    }
+    TURBO_UNLOCK();
+}
+
+size_t getTurboSettings(TurboSetting *out, size_t max) {
+    size_t count = 0;
+    TURBO_LOCK();
+    uint16_t mask = turboMask.load(std::memory_order_relaxed);
+    for (int i = 0; i < TURBO_BUTTON_COUNT && count < max; i++) {
+        if (mask & (1u << i)) out[count++] = turboSettings[i];
+    }
+    TURBO_UNLOCK();
+    return count;
+}
+
+static const char *turboButtonName(uint16_t bit) {
+    for (size_t i = 0; i < BUTTON_COUNT; i++) {
+        if (BUTTON_TABLE[i].kind == BUTTON_KIND_BUTTON && BUTTON_TABLE[i].bit == bit) return BUTTON_TABLE[i].name;
+    }
+    return "";
+}
+
+size_t formatTurboStatus(char *out, size_t size) {
+    TurboSetting settings[TURBO_BUTTON_COUNT];
+    size_t count = getTurboSettings(settings, TURBO_BUTTON_COUNT);
+
+    int length = snprintf(out, size, "{\"interval_ms\":%d,\"turbo\":[", REPORT_INTERVAL_MS);
+    for (size_t i = 0; i < count && length > 0 && (size_t)length < size; i++) {
+        const TurboSetting &setting = settings[i];
+        // 実際の周波数・デューティ比（レポート周期単位に丸めた値）
+        length += snprintf(out + length, size - length,
+                           "%s{\"button\":\"%s\",\"hz\":%.2f,\"duty\":%d,\"period_frames\":%u,\"on_frames\":%u}",
+                           i == 0 ? "" : ",", turboButtonName(setting.bit),
+                           1000.0f / (setting.period * REPORT_INTERVAL_MS),
+                           setting.on * 100 / setting.period,
+                           (unsigned)setting.period, (unsigned)setting.on);
+    }
+    if (length > 0 && (size_t)length < size) {
+        length += snprintf(out + length, size - length, "]}");
+    }
+    return length > 0 && (size_t)length < size ? length : 0;
+}
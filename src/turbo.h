@@ -0,0 +1,51 @@
+#ifndef TURBO_H
+#define TURBO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "switch_report.h"
+
+// ボタン（SWITCH_BTN_*のビット）の数
+#define TURBO_BUTTON_COUNT 16
+
+// 連打の設定（周期・押下時間はレポート周期の数）
+struct TurboSetting {
+    uint16_t bit = 0;            // SWITCH_BTN_*（0なら未設定）
+    uint16_t period = 0;         // 1回の押して離す周期（レポート数）
+    uint16_t on = 0;             // 周期のうち押下するレポート数
+    uint32_t start_frame = 0;    // 開始したレポート周期の番号（押下から始まる）
+};
+
+/**
+ * ボタン名（表示名またはJSONのキー、大文字小文字を区別しない）からSWITCH_BTN_*を検索（見つからなければ0）
+ */
+uint16_t findTurboButton(const char *name);
+
+/**
+ * 連打を開始（hz: 回/秒、duty: 押下の割合%）。周期はレポート周期単位に丸め、次のレポートから押下
+ * 周波数が範囲外（レポート周期2回で1回より速い、またはTURBO_MAX_PERIOD_MSより遅い）ならfalse
+ */
+bool startTurbo(uint16_t bit, float hz, uint8_t duty);
+
+/**
+ * 連打を停止（bit=0なら全ボタン）
+ */
+void stopTurbo(uint16_t bit);
+
+/**
+ * 連打中のボタンの押下/解放をレポートに反映（入力より優先）。frameは送信するレポート周期の番号
+ * レポート送信側のみ呼ぶ
+ */
+void applyTurbo(SwitchReport &report, uint32_t frame);
+
+/**
+ * 連打の設定を取得（連打中のボタン数を返す）
+ */
+size_t getTurboSettings(TurboSetting *out, size_t max);
+
+/**
+ * 連打の設定をJSONで出力（長さを返す、収まらなければ0）
+ */
+size_t formatTurboStatus(char *out, size_t size);
+
+#endif // TURBO_H
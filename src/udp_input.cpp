@@ -0,0 +1,38 @@
+#include "udp_input.h"
+#include "wifi_manager.h"
+#include "web_server.h"
+#include "env.h"
+#include <WiFiUdp.h>
+
+// UDP受信（実体）
+static WiFiUDP udp;
+static bool udp_started = false;
+static FrameReceiver udpReceiver;
+static FrameSender udpSenders[UDP_MAX_SENDERS];
+
+// 受信バッファ（最大フレームサイズ）
+static uint8_t udpBuffer[sizeof(UdpFrameHeader) + sizeof(UdpFrameState) * UDP_MAX_STATES];
+
+void initUdpInput() {
+    // WiFi接続前でも待ち受けを開始（接続・再接続後にそのまま受信）
+    udp_started = udp.begin(UDP_INPUT_PORT);
+}
+
+void handleUdpInput() {
+    if (!udp_started || !wifi_connected) return;
+
+    // 溜まっているパケットを全て処理
+    int size;
+    while ((size = udp.parsePacket()) > 0) {
+        int length = udp.read(udpBuffer, sizeof(udpBuffer));
+        FrameSequence &sequence = findFrameSender(udpSenders, UDP_MAX_SENDERS,
+                                                  (uint32_t)udp.remoteIP(), udp.remotePort());
+        lockWebInput();
+        applyInputFrame(udpReceiver, sequence, udpBuffer, length, millis());
+        unlockWebInput();
+    }
+}
+
+UdpInputStats getUdpInputStats() {
+    return udpReceiver.stats;
+}
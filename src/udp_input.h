@@ -0,0 +1,22 @@
+#ifndef UDP_INPUT_H
+#define UDP_INPUT_H
+
+#include "types.h"
+#include "input_frame.h"
+
+/**
+ * UDP入力受信開始
+ */
+void initUdpInput();
+
+/**
+ * 受信済みUDPパケットを全て処理
+ */
+void handleUdpInput();
+
+/**
+ * UDP受信統計を取得
+ */
+UdpInputStats getUdpInputStats();
+
+#endif // UDP_INPUT_H
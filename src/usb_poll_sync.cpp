@@ -0,0 +1,130 @@
+#include "usb_poll_sync.h"
+#include "env.h"
+#include <atomic>
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#endif
+
+// 統計の排他（更新はレポート送信側、読み出しはWebサーバー側）
+#ifdef ESP_PLATFORM
+static portMUX_TYPE pollSyncMux = portMUX_INITIALIZER_UNLOCKED;
+#define POLL_SYNC_LOCK() portENTER_CRITICAL(&pollSyncMux)
+#define POLL_SYNC_UNLOCK() portEXIT_CRITICAL(&pollSyncMux)
+#else
+static std::atomic_flag pollSyncFlag = ATOMIC_FLAG_INIT;
+#define POLL_SYNC_LOCK() while (pollSyncFlag.test_and_set(std::memory_order_acquire)) {}
+#define POLL_SYNC_UNLOCK() pollSyncFlag.clear(std::memory_order_release)
+#endif
+
+// 予測から外れ続けたら取り直す（ポーリング間隔の1/4以上の差がこの回数続いた場合）
+#define POLL_SYNC_RELOCK_MISSES 8
+
+// 推定したポーリング間隔の許容範囲（USBのSOFは±500ppm）
+#define POLL_SYNC_MAX_PPM 1000
+
+// ポーリング時刻の予測（レポート送信側のみ使用）。間隔はus×256の固定小数点
+static const int64_t NOMINAL_Q8 = (int64_t)USB_POLL_INTERVAL_US << 8;
+static int64_t anchorUs = 0;           // 直近に予測したポーリング時刻
+static int64_t periodQ8 = NOMINAL_Q8;
+static uint32_t misses = 0;
+
+static UsbPollSyncStats pollStats;
+
+// 基準からの間隔数を四捨五入で求める
+static int64_t nearestPoll(int64_t time_us) {
+    int64_t offsetQ8 = (time_us - anchorUs) * 256;
+    int64_t polls = offsetQ8 >= 0 ? (offsetQ8 + periodQ8 / 2) / periodQ8
+                                  : -((-offsetQ8 + periodQ8 / 2) / periodQ8);
+    return polls;
+}
+
+static int64_t pollTime(int64_t polls) {
+    return anchorUs + polls * periodQ8 / 256;
+}
+
+void recordUsbPollComplete(int64_t submit_us, int64_t complete_us) {
+    // 同期しない場合も待ち時間を比較できるよう予測・統計は更新する
+    // 送信直後の完了はポーリングを待っていない（ホスト未接続時のエラー等）、間隔の1.5倍以上は取りこぼし
+    int64_t wait = complete_us - submit_us;
+    if (wait < USB_POLL_MIN_WAIT_US || wait > USB_POLL_INTERVAL_US * 3 / 2) {
+        POLL_SYNC_LOCK();
+        pollStats.ignored++;
+        POLL_SYNC_UNLOCK();
+        return;
+    }
+
+    POLL_SYNC_LOCK();
+    UsbPollSyncStats stats = pollStats;
+    POLL_SYNC_UNLOCK();
+
+    int32_t error = 0;
+    if (stats.samples == 0) {
+        anchorUs = complete_us;
+        periodQ8 = NOMINAL_Q8;
+    } else {
+        int64_t polls = nearestPoll(complete_us);
+        int64_t predicted = pollTime(polls);
+        error = (int32_t)(complete_us - predicted);
+
+        if (error > USB_POLL_INTERVAL_US / 4 || error < -USB_POLL_INTERVAL_US / 4) {
+            misses++;
+        } else {
+            misses = 0;
+        }
+
+        if (misses >= POLL_SYNC_RELOCK_MISSES) {
+            // ホストの再接続等でポーリング時刻が変わった
+            anchorUs = complete_us;
+            periodQ8 = NOMINAL_Q8;
+            misses = 0;
+            stats.samples = 0;
+            stats.relocks++;
+        } else {
+            // 位相は差の1/8、間隔は1間隔あたりの差の1/256ずつ補正（完了時刻の揺れで間隔が振れないよう小さく）
+            anchorUs = predicted + error / 8;
+            if (polls > 0) {
+                periodQ8 += (int64_t)error / polls;
+                int64_t limit = NOMINAL_Q8 * POLL_SYNC_MAX_PPM / 1000000;
+                if (periodQ8 > NOMINAL_Q8 + limit) periodQ8 = NOMINAL_Q8 + limit;
+                if (periodQ8 < NOMINAL_Q8 - limit) periodQ8 = NOMINAL_Q8 - limit;
+            }
+        }
+    }
+
+    uint32_t absError = error < 0 ? -error : error;
+    stats.samples++;
+    stats.locked = stats.samples >= USB_POLL_LOCK_SAMPLES;
+    stats.phase_error_us = error;
+    stats.avg_abs_error_us = stats.samples == 1 ? absError
+                                                : stats.avg_abs_error_us - stats.avg_abs_error_us / 16 + absError / 16;
+    if (stats.locked && absError > stats.max_abs_error_us) stats.max_abs_error_us = absError;
+    stats.last_wait_us = (uint32_t)wait;
+    stats.avg_wait_us = stats.avg_wait_us == 0 ? (uint32_t)wait
+                                               : stats.avg_wait_us - stats.avg_wait_us / 16 + (uint32_t)wait / 16;
+    stats.drift_ppm = (int32_t)((periodQ8 - NOMINAL_Q8) * 1000000 / NOMINAL_Q8);
+
+    POLL_SYNC_LOCK();
+    pollStats = stats;
+    POLL_SYNC_UNLOCK();
+}
+
+int64_t nextReportWake(int64_t previous_us) {
+    int64_t next = previous_us + REPORT_INTERVAL_MS * 1000;
+    if (!ENABLE_USB_POLL_SYNC) return next;
+
+    POLL_SYNC_LOCK();
+    bool locked = pollStats.locked;
+    POLL_SYNC_UNLOCK();
+    if (!locked) return next;
+
+    // 固定周期の予定に最も近いポーリングの少し前に起床（送信がポーリングに間に合うように）
+    return pollTime(nearestPoll(next + USB_POLL_LEAD_US)) - USB_POLL_LEAD_US;
+}
+
+UsbPollSyncStats getUsbPollSyncStats() {
+    POLL_SYNC_LOCK();
+    UsbPollSyncStats stats = pollStats;
+    POLL_SYNC_UNLOCK();
+    stats.enabled = ENABLE_USB_POLL_SYNC;
+    return stats;
+}
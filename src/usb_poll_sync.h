@@ -0,0 +1,38 @@
+#ifndef USB_POLL_SYNC_H
+#define USB_POLL_SYNC_H
+
+#include <stdint.h>
+
+// ホストのポーリングへの同期の統計
+struct UsbPollSyncStats {
+    bool enabled = false;          // ENABLE_USB_POLL_SYNC
+    bool locked = false;           // ポーリング時刻を予測できている（USB_POLL_LOCK_SAMPLES以上、無効時も予測のみ行う）
+    uint32_t samples = 0;          // 予測に使ったIN転送完了の数
+    uint32_t ignored = 0;          // 送信直後に完了した・完了が遅すぎたため使わなかった数
+    uint32_t relocks = 0;          // 予測から外れ続けたため取り直した回数
+    int32_t phase_error_us = 0;    // 直近の完了時刻と予測したポーリング時刻の差（us）
+    uint32_t avg_abs_error_us = 0; // 差の絶対値の平均（us、指数移動平均）
+    uint32_t max_abs_error_us = 0; // 差の絶対値の最大（us、ロック後）
+    uint32_t last_wait_us = 0;     // 直近のレポートが送信からポーリングまで待った時間（us）
+    uint32_t avg_wait_us = 0;      // 待ち時間の平均（us、指数移動平均）
+    int32_t drift_ppm = 0;         // 推定したポーリング間隔のUSB_POLL_INTERVAL_USからのずれ（ppm）
+};
+
+/**
+ * レポートの送信開始時刻とIN転送完了（ホストのポーリング）時刻を記録してポーリング時刻の予測を更新
+ * レポート送信側のみ呼ぶ
+ */
+void recordUsbPollComplete(int64_t submit_us, int64_t complete_us);
+
+/**
+ * 前回の起床時刻から次のレポートを作成する時刻を求める（予測したポーリングのUSB_POLL_LEAD_US前）
+ * 予測できていなければREPORT_INTERVAL_MS後。レポート送信側のみ呼ぶ
+ */
+int64_t nextReportWake(int64_t previous_us);
+
+/**
+ * ポーリングへの同期の統計を取得
+ */
+UsbPollSyncStats getUsbPollSyncStats();
+
+#endif // USB_POLL_SYNC_H
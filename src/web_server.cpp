@@ -1,13 +1,53 @@
 #include "web_server.h"
 #include "wifi_manager.h"
 #include "lcd_display.h"
+#include "controller_input.h"
+#include "udp_input.h"
+#include "ws_input.h"
+#include "input_scheduler.h"
+#include "macro_store.h"
+#include "async_http.h"
+#include "metrics.h"
+#include "soak_monitor.h"
+#include "input_edges.h"
+#include "input_clock.h"
+#include "input_ingest.h"
+#include "stick_jitter.h"
+#include "stick_curve.h"
+#include "turbo.h"
+#include "usb_poll_sync.h"
+#include "hal.h"
 #include "env.h"
 
+// Web入力の公開時刻を記録（公開からレポート送信までの計測用）
+static void onInputPublished() {
+    markInputPublished(metricsStamp());
+}
+
 void initWebServer() {
-    if (!wifi_connected) return;
+    setInputPublishHook(onInputPublished);
     
+    // WiFi接続前でも待ち受けを開始（接続・再接続後にそのまま受信）
+    // 管理用（WEB_ADMIN_PORT）。/controllerと/は非同期HTTP（WEB_SERVER_PORT）でも受け付ける
     server.on("/", handleRoot);
     server.on("/controller", HTTP_POST, handleControllerPOST);
+    server.on("/stats", HTTP_GET, handleStatsGET);
+    server.on("/metrics", HTTP_GET, handleMetricsGET);
+    server.on("/soak", HTTP_GET, handleSoakGET);
+    server.on("/timeline", HTTP_POST, handleTimelinePOST);
+    server.on("/timeline", HTTP_GET, handleTimelineGET);
+    server.on("/timeline", HTTP_DELETE, handleTimelineDELETE);
+    server.on("/macros", HTTP_GET, handleMacroListGET);
+    server.on("/macro", HTTP_GET, handleMacroGET);
+    server.on("/macro", HTTP_DELETE, handleMacroDELETE);
+    server.on("/macro/upload", HTTP_POST, handleMacroUploadPOST);
+    server.on("/macro/start", HTTP_POST, handleMacroStartPOST);
+    server.on("/macro/stop", HTTP_POST, handleMacroStopPOST);
+    server.on("/stick", HTTP_GET, handleStickGET);
+    server.on("/stick", HTTP_POST, handleStickPOST);
+    server.on("/turbo", HTTP_GET, handleTurboGET);
+    server.on("/turbo", HTTP_POST, handleTurboPOST);
+    server.on("/turbo", HTTP_DELETE, handleTurboDELETE);
     
     // CORS対応
     server.enableCORS(true);
@@ -15,157 +55,562 @@ void initWebServer() {
     server.begin();
 }
 
+// handleClient()の開始時刻（リクエスト受信時間の計測用）
+static uint32_t clientStamp = 0;
+
 void handleWebServer() {
     if (wifi_connected) {
+        clientStamp = metricsStamp();
         server.handleClient();
+        recordStage(METRIC_HANDLE_CLIENT, clientStamp);
     }
 }
 
+// ルートページ（WebServer/非同期HTTP共通）
+const char ROOT_PAGE_HTML[] =
+    "<!DOCTYPE html><html><head><meta charset='UTF-8'>"
+    "<title>Nintendo Switch Controller</title></head><body>"
+    "<h1>Nintendo Switch Controller Web Interface</h1>"
+    "<p>POST /controller endpoint ready</p>"
+    "<h2>JSON Format:</h2>"
+    "<pre>{<br>"
+    "  \"buttons\": {\"A\": true, \"B\": false, \"X\": false, \"Y\": false},<br>"
+    "  \"lstick\": {\"x\": 0, \"y\": 0, \"press\": false},<br>"
+    "  \"rstick\": {\"x\": 0, \"y\": 0, \"press\": false},<br>"
+    "  \"shoulder\": {\"L\": false, \"R\": false, \"ZL\": false, \"ZR\": false},<br>"
+    "  \"system\": {\"plus\": false, \"minus\": false, \"home\": false, \"capture\": false},<br>"
+    "  \"dpad\": {\"up\": false, \"down\": false, \"left\": false, \"right\": false}<br>"
+    "}</pre>"
+    "<p>Sticks: x,y range -100 to 100</p>"
+    "</body></html>";
+
+const size_t ROOT_PAGE_HTML_LENGTH = sizeof(ROOT_PAGE_HTML) - 1;
+
 void handleRoot() {
-    String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'>";
-    html += "<title>Nintendo Switch Controller</title></head><body>";
-    html += "<h1>Nintendo Switch Controller Web Interface</h1>";
-    html += "<p>POST /controller endpoint ready</p>";
-    html += "<h2>JSON Format:</h2>";
-    html += "<pre>{<br>";
-    html += "  \"buttons\": {\"A\": true, \"B\": false, \"X\": false, \"Y\": false},<br>";
-    html += "  \"lstick\": {\"x\": 0, \"y\": 0},<br>";
-    html += "  \"rstick\": {\"x\": 0, \"y\": 0},<br>";
-    html += "  \"shoulder\": {\"L\": false, \"R\": false, \"ZL\": false, \"ZR\": false},<br>";
-    html += "  \"system\": {\"plus\": false, \"minus\": false, \"home\": false}<br>";
-    html += "}</pre>";
-    html += "<p>Sticks: x,y range -100 to 100</p>";
-    html += "</body></html>";
-    
-    server.send(200, "text/html", html);
+    server.send_P(200, "text/html", ROOT_PAGE_HTML, ROOT_PAGE_HTML_LENGTH);
 }
 
+// 固定レスポンス（String生成なし）
+static const char REPLY_OK[] = "{\"status\":\"OK\"}";
+static const char REPLY_NO_BODY[] = "{\"error\":\"No JSON body\"}";
+static const char REPLY_INVALID[] = "{\"error\":\"Invalid JSON\"}";
+static const char REPLY_BAD_DURATION[] = "{\"error\":\"Invalid duration\"}";
+static const char REPLY_BAD_NAME[] = "{\"error\":\"Invalid macro name\"}";
+static const char REPLY_NOT_FOUND[] = "{\"error\":\"Macro not found\"}";
+static const char REPLY_FS_ERROR[] = "{\"error\":\"Storage error\"}";
+static const char REPLY_MACRO_PLAYING[] = "{\"error\":\"Macro is playing\"}";
+static const char REPLY_BAD_REPEAT[] = "{\"error\":\"Invalid repeat\"}";
+static const char REPLY_BAD_STICK[] = "{\"error\":\"Invalid stick or profile\"}";
+static const char REPLY_STICK_PENDING[] = "{\"error\":\"Previous profile change pending\"}";
+static const char REPLY_BAD_BUTTON[] = "{\"error\":\"Invalid button\"}";
+static const char REPLY_BAD_TURBO[] = "{\"error\":\"Invalid hz or duty\"}";
+
 void handleControllerPOST() {
+    // WebServerは本文まで読み込んでからハンドラーを呼ぶため、ここまでが受信時間
+    recordStage(METRIC_HTTP_RECEIVE, clientStamp);
+    
+    // 本文の取得はWebServerのStringのまま（解析は固定領域で行いヒープ確保なし）
+    uint32_t handlerStamp = metricsStamp();
+    char buffer[CONTROLLER_REPLY_SIZE];
+    const char *reply;
+    size_t replyLength;
+    int code;
     if (server.hasArg("plain")) {
-        String body = server.arg("plain");
-        JsonDocument doc;
-        
-        DeserializationError error = deserializeJson(doc, body);
-        if (error) {
-            server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-            return;
-        }
-        
-        unsigned long currentTime = millis();
-        String latestInput = "";
-        
-        // ボタン状態更新
-        if (doc["buttons"].is<JsonObject>()) {
-            JsonObject buttons = doc["buttons"];
-            
-            // 各ボタンの状態更新と最新入力追跡
-            if (buttons["A"] | false) { webButtons.A = true; latestInput = "A"; }
-            else { webButtons.A = false; }
-            
-            if (buttons["B"] | false) { webButtons.B = true; latestInput = "B"; }
-            else { webButtons.B = false; }
-            
-            if (buttons["X"] | false) { webButtons.X = true; latestInput = "X"; }
-            else { webButtons.X = false; }
-            
-            if (buttons["Y"] | false) { webButtons.Y = true; latestInput = "Y"; }
-            else { webButtons.Y = false; }
-        }
+        const String &body = server.arg("plain");
+        code = processControllerBody(body.c_str(), body.length(), buffer, sizeof(buffer), reply, replyLength);
+    } else {
+        code = processControllerBody(nullptr, 0, buffer, sizeof(buffer), reply, replyLength);
+    }
+    if (code == 200) recordStage(METRIC_HTTP_PARSE, handlerStamp);
+    server.send_P(code, "application/json", reply, replyLength);
+}
+
+void handleStatsGET() {
+    ReportTimingStats stats = getReportTimingStats();
+    uint32_t avg_jitter_us = stats.cycles > 0 ? (uint32_t)(stats.total_jitter_us / stats.cycles) : 0;
+    
+    UdpInputStats udp = getUdpInputStats();
+    WsInputStats ws = getWebSocketInputStats();
+    WiFiLinkStats wifi = getWiFiLinkStats();
+    AsyncHttpStats http = getAsyncHttpStats();
+    HeapSample heap = sampleHeap();
+    SoakSummary soak = getSoakSummary();
+    ReportEmitStats emit = getReportEmitStats();
+    InputEdgeStats edges = getInputEdgeStats();
+    ScheduledInputStats schedule = getScheduledInputStats();
+    StickJitterStats jitter = getStickJitterStats();
+    UsbPollSyncStats poll = getUsbPollSyncStats();
+    
+    char json[2048];
+    snprintf(json, sizeof(json),
+             "{\"interval_ms\":%d,\"cycles\":%lu,\"last_us\":%lu,\"min_us\":%lu,\"max_us\":%lu,"
+             "\"avg_jitter_us\":%lu,\"max_jitter_us\":%lu,\"overruns\":%lu,"
+             "\"report\":{\"sent\":%lu,\"suppressed\":%lu,\"keepalive\":%lu,\"avg_send_us\":%lu,"
+             "\"max_send_us\":%lu,\"saved_bytes\":%llu,\"saved_send_us\":%llu},"
+             "\"usb_poll\":{\"enabled\":%s,\"locked\":%s,\"samples\":%lu,\"ignored\":%lu,\"relocks\":%lu,"
+             "\"phase_error_us\":%ld,\"avg_abs_error_us\":%lu,\"max_abs_error_us\":%lu,\"wait_us\":%lu,"
+             "\"avg_wait_us\":%lu,\"drift_ppm\":%ld},"
+             "\"edges\":{\"events\":%lu,\"presses\":%lu,\"stretched\":%lu,\"coalesced\":%lu,\"dropped\":%lu,\"ignored\":%lu},"
+             "\"schedule\":{\"queued\":%lu,\"applied\":%lu,\"late\":%lu,\"rejected\":%lu,\"pending\":%lu,"
+             "\"max_late_us\":%lu},"
+             "\"stick_jitter\":{\"enabled\":%s,\"active\":%s,\"depth_ms\":%lu,\"buffered\":%lu,\"samples\":%lu,"
+             "\"late\":%lu,\"overflow\":%lu,\"underruns\":%lu},"
+             "\"udp\":{\"packets\":%lu,\"applied\":%lu,\"recovered\":%lu,\"stale\":%lu,\"invalid\":%lu,\"sessions\":%lu,\"last_seq\":%lu},"
+             "\"ws\":{\"clients\":%lu,\"text\":%lu,\"binary\":%lu,\"rejected\":%lu},"
+             "\"wifi\":{\"state\":\"%s\",\"attempts\":%lu,\"connects\":%lu,\"disconnects\":%lu,"
+             "\"backoff_ms\":%lu,\"last_reason\":%u},"
+             "\"http\":{\"accepted\":%lu,\"active\":%lu,\"rejected\":%lu,\"requests\":%lu,\"errors\":%lu},"
+             "\"heap\":{\"free\":%lu,\"largest_block\":%lu,\"min_free\":%lu,\"fragmentation\":%u,"
+             "\"soak\":{\"enabled\":%s,\"samples\":%lu,\"free_trend\":%ld,\"largest_trend\":%ld}}}",
+             REPORT_INTERVAL_MS,
+             (unsigned long)stats.cycles,
+             (unsigned long)stats.last_interval_us,
+             (unsigned long)stats.min_interval_us,
+             (unsigned long)stats.max_interval_us,
+             (unsigned long)avg_jitter_us,
+             (unsigned long)stats.max_jitter_us,
+             (unsigned long)stats.overruns,
+             (unsigned long)emit.sent,
+             (unsigned long)emit.suppressed,
+             (unsigned long)emit.keepalive,
+             (unsigned long)emit.avg_send_us,
+             (unsigned long)emit.max_send_us,
+             (unsigned long long)emit.suppressed * SWITCH_REPORT_SIZE,
+             (unsigned long long)emit.suppressed * emit.avg_send_us,
+             poll.enabled ? "true" : "false",
+             poll.locked ? "true" : "false",
+             (unsigned long)poll.samples,
+             (unsigned long)poll.ignored,
+             (unsigned long)poll.relocks,
+             (long)poll.phase_error_us,
+             (unsigned long)poll.avg_abs_error_us,
+             (unsigned long)poll.max_abs_error_us,
+             (unsigned long)poll.last_wait_us,
+             (unsigned long)poll.avg_wait_us,
+             (long)poll.drift_ppm,
+             (unsigned long)edges.events,
+             (unsigned long)edges.presses,
+             (unsigned long)edges.stretched,
+             (unsigned long)edges.coalesced,
+             (unsigned long)edges.dropped,
+             (unsigned long)edges.ignored,
+             (unsigned long)schedule.queued,
+             (unsigned long)schedule.applied,
+             (unsigned long)schedule.late,
+             (unsigned long)schedule.rejected,
+             (unsigned long)schedule.pending,
+             (unsigned long)schedule.max_late_us,
+             jitter.enabled ? "true" : "false",
+             jitter.active ? "true" : "false",
+             (unsigned long)jitter.depth_ms,
+             (unsigned long)jitter.buffered,
+             (unsigned long)jitter.samples,
+             (unsigned long)jitter.late,
+             (unsigned long)jitter.overflow,
+             (unsigned long)jitter.underruns,
+             (unsigned long)udp.packets,
+             (unsigned long)udp.applied,
+             (unsigned long)udp.recovered,
+             (unsigned long)udp.stale,
+             (unsigned long)udp.invalid,
+             (unsigned long)udp.sessions,
+             (unsigned long)udp.last_seq,
+             (unsigned long)ws.clients,
+             (unsigned long)ws.text_frames,
+             (unsigned long)ws.binary_frames,
+             (unsigned long)ws.rejected,
+             wifiStateName(wifi.state),
+             (unsigned long)wifi.attempts,
+             (unsigned long)wifi.connects,
+             (unsigned long)wifi.disconnects,
+             (unsigned long)wifi.backoff_ms,
+             (unsigned)wifi.last_reason,
+             (unsigned long)http.accepted,
+             (unsigned long)http.active,
+             (unsigned long)http.rejected,
+             (unsigned long)http.requests,
+             (unsigned long)http.errors,
+             (unsigned long)heap.free_bytes,
+             (unsigned long)heap.largest_block,
+             (unsigned long)heap.min_free_bytes,
+             (unsigned)heapFragmentation(heap),
+             soak.enabled ? "true" : "false",
+             (unsigned long)soak.samples,
+             (long)soak.free_trend,
+             (long)soak.largest_trend);
+    
+    // ?reset=1 で計測値をリセット
+    if (server.hasArg("reset")) {
+        resetReportTimingStats();
+    }
+    
+    server.send(200, "application/json", json);
+}
+
+void handleMetricsGET() {
+    // 区切りごとにチャンク送信（全体を1つのバッファに組み立てない）
+    static char section[METRICS_SECTION_SIZE];
+    
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4", "");
+    size_t length;
+    for (size_t i = 0; (length = formatMetricsSection(i, section, sizeof(section))) > 0; i++) {
+        server.sendContent(section, length);
+    }
+    server.sendContent("");
+}
+
+void handleSoakGET() {
+    if (!ENABLE_SOAK_TEST) {
+        server.send(404, "application/json", "{\"error\":\"Soak test disabled\"}");
+        return;
+    }
+    
+    // 記録したサンプルをCSVでチャンク送信
+    static char section[1024];
+    
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/csv", "");
+    size_t length;
+    for (size_t i = 0; (length = formatSoakSection(i, section, sizeof(section))) > 0; i++) {
+        server.sendContent(section, length);
+    }
+    server.sendContent("");
+}
+
+// タイムライン解析用バッファ（loop()からのみ使用）
+static TimelineFrame timelineBuffer[TIMELINE_MAX_FRAMES];
+
+// タイムライン再生状態をJSONで送信
+static void sendTimelineStatus(int code, uint16_t id) {
+    TimelineStatus status = getTimelineStatus();
+    
+    char json[320];
+    snprintf(json, sizeof(json),
+             "{\"id\":%u,\"playing\":%s,\"current_id\":%u,\"last_completed_id\":%u,"
+             "\"queued\":%lu,\"free\":%u,\"played_frames\":%lu,\"completed\":%lu,"
+             "\"aborted\":%lu,\"max_late_us\":%lu}",
+             id,
+             status.playing ? "true" : "false",
+             status.current_id,
+             status.last_completed_id,
+             (unsigned long)status.queued_frames,
+             (unsigned)timelineFreeFrames(),
+             (unsigned long)status.played_frames,
+             (unsigned long)status.completed,
+             (unsigned long)status.aborted,
+             (unsigned long)status.max_late_us);
+    
+    server.send(code, "application/json", json);
+}
+
+// フレーム配列を解析してbufferへ展開（不正な保持時間があれば0を返す）
+// 各フレームは前フレームの状態に差分を上書き（ニュートラルから開始）
+// 保持時間は"duration"（ms）、または"at"（シーケンス開始からのms）の差分で指定
+static size_t parseTimelineFrames(JsonArrayConst frames, TimelineFrame *buffer, uint16_t id) {
+    size_t count = frames.size();
+    ControllerState state;
+    for (size_t i = 0; i < count; i++) {
+        JsonObjectConst frame = frames[i];
+        applyControllerJson(frame, state, 0);
         
-        // 左スティック状態更新
-        if (doc["lstick"].is<JsonObject>()) {
-            JsonObject lstick = doc["lstick"];
-            int new_x = lstick["x"] | 0;
-            int new_y = lstick["y"] | 0;
-            
-            // 範囲制限
-            new_x = constrain(new_x, -100, 100);
-            new_y = constrain(new_y, -100, 100);
-            
-            webButtons.lstick_x = new_x;
-            webButtons.lstick_y = new_y;
-            
-            // スティック入力がある場合（閾値10以上）
-            if (abs(new_x) > 10 || abs(new_y) > 10) {
-                latestInput = "STICK_L";
-            }
+        long duration = frame["duration"] | -1L;
+        if (duration < 0 && i + 1 < count && frame["at"].is<long>() && frames[i + 1]["at"].is<long>()) {
+            duration = frames[i + 1]["at"].as<long>() - frame["at"].as<long>();
         }
-        
-        // 右スティック状態更新
-        if (doc["rstick"].is<JsonObject>()) {
-            JsonObject rstick = doc["rstick"];
-            int new_x = rstick["x"] | 0;
-            int new_y = rstick["y"] | 0;
-            
-            // 範囲制限
-            new_x = constrain(new_x, -100, 100);
-            new_y = constrain(new_y, -100, 100);
-            
-            webButtons.rstick_x = new_x;
-            webButtons.rstick_y = new_y;
-            
-            // スティック入力がある場合（閾値10以上）
-            if (abs(new_x) > 10 || abs(new_y) > 10) {
-                latestInput = "STICK_R";
-            }
+        if (duration < 1 || duration > TIMELINE_MAX_DURATION_MS) {
+            return 0;
         }
         
-        // ショルダーボタン状態更新
-        if (doc["shoulder"].is<JsonObject>()) {
-            JsonObject shoulder = doc["shoulder"];
-            
-            if (shoulder["L"] | false) { webButtons.L = true; latestInput = "L"; }
-            else { webButtons.L = false; }
-            
-            if (shoulder["R"] | false) { webButtons.R = true; latestInput = "R"; }
-            else { webButtons.R = false; }
-            
-            if (shoulder["ZL"] | false) { webButtons.ZL = true; latestInput = "ZL"; }
-            else { webButtons.ZL = false; }
-            
-            if (shoulder["ZR"] | false) { webButtons.ZR = true; latestInput = "ZR"; }
-            else { webButtons.ZR = false; }
+        buffer[i].state = state;
+        buffer[i].duration_ms = (uint32_t)duration;
+        buffer[i].sequence_id = id;
+    }
+    return count;
+}
+
+void handleTimelinePOST() {
+    if (!server.hasArg("plain")) {
+        server.send_P(400, "application/json", REPLY_NO_BODY, sizeof(REPLY_NO_BODY) - 1);
+        return;
+    }
+    
+    // マクロ再生中はタイムラインを使用中
+    if (isMacroPlaying()) {
+        sendTimelineStatus(409, 0);
+        return;
+    }
+    
+    // シーケンス登録は1リクエストにつき1回のため通常のJsonDocumentで解析
+    JsonDocument doc;
+    if (deserializeJson(doc, server.arg("plain"))) {
+        server.send_P(400, "application/json", REPLY_INVALID, sizeof(REPLY_INVALID) - 1);
+        return;
+    }
+    
+    JsonArrayConst frames = doc["frames"];
+    size_t count = frames.size();
+    if (count == 0 || count > timelineFreeFrames()) {
+        // フレームなし、またはキューの空き不足
+        sendTimelineStatus(count == 0 ? 400 : 409, 0);
+        return;
+    }
+    
+    uint16_t id = nextTimelineId();
+    if (parseTimelineFrames(frames, timelineBuffer, id) == 0) {
+        server.send_P(400, "application/json", REPLY_BAD_DURATION, sizeof(REPLY_BAD_DURATION) - 1);
+        return;
+    }
+    
+    if (!queueTimeline(timelineBuffer, count)) {
+        sendTimelineStatus(409, 0);
+        return;
+    }
+    
+    sendTimelineStatus(200, id);
+}
+
+void handleTimelineGET() {
+    sendTimelineStatus(200, 0);
+}
+
+void handleTimelineDELETE() {
+    abortTimeline();
+    sendTimelineStatus(200, 0);
+}
+
+// マクロ再生状態をJSONで送信
+static void sendMacroStatus(int code) {
+    MacroStatus status = getMacroStatus();
+    TimelineStatus timeline = getTimelineStatus();
+    
+    char json[320];
+    snprintf(json, sizeof(json),
+             "{\"playing\":%s,\"name\":\"%s\",\"frames\":%lu,\"fed\":%lu,\"loops\":%lu,"
+             "\"repeat\":%lu,\"underruns\":%lu,\"max_late_us\":%lu}",
+             status.playing ? "true" : "false",
+             status.name,
+             (unsigned long)status.total_frames,
+             (unsigned long)status.fed_frames,
+             (unsigned long)status.loops_done,
+             (unsigned long)status.repeat,
+             (unsigned long)status.underruns,
+             (unsigned long)timeline.max_late_us);
+    
+    server.send(code, "application/json", json);
+}
+
+void handleMacroUploadPOST() {
+    if (!server.hasArg("plain")) {
+        server.send_P(400, "application/json", REPLY_NO_BODY, sizeof(REPLY_NO_BODY) - 1);
+        return;
+    }
+    
+    const String &name = server.arg("name");
+    if (!isValidMacroName(name.c_str())) {
+        server.send_P(400, "application/json", REPLY_BAD_NAME, sizeof(REPLY_BAD_NAME) - 1);
+        return;
+    }
+    
+    JsonDocument doc;
+    if (deserializeJson(doc, server.arg("plain"))) {
+        server.send_P(400, "application/json", REPLY_INVALID, sizeof(REPLY_INVALID) - 1);
+        return;
+    }
+    
+    // 1リクエストはタイムラインと同じ最大フレーム数まで（長いマクロは?append=1で分割送信）
+    JsonArrayConst frames = doc["frames"];
+    size_t count = frames.size();
+    if (count == 0 || count > TIMELINE_MAX_FRAMES) {
+        server.send_P(400, "application/json", REPLY_INVALID, sizeof(REPLY_INVALID) - 1);
+        return;
+    }
+    
+    // 解析バッファはloop()からのみ使用するためタイムラインと共用
+    if (parseTimelineFrames(frames, timelineBuffer, 0) == 0) {
+        server.send_P(400, "application/json", REPLY_BAD_DURATION, sizeof(REPLY_BAD_DURATION) - 1);
+        return;
+    }
+    
+    bool append = server.arg("append") == "1";
+    MacroInfo info;
+    switch (writeMacroFrames(name.c_str(), timelineBuffer, count, append, &info)) {
+        case MACRO_WRITE_OK: {
+            char json[160];
+            snprintf(json, sizeof(json), "{\"name\":\"%s\",\"frames\":%lu,\"duration_ms\":%lu,\"bytes\":%lu}",
+                     info.name,
+                     (unsigned long)info.frames,
+                     (unsigned long)info.duration_ms,
+                     (unsigned long)info.bytes);
+            server.send(200, "application/json", json);
+            break;
         }
-        
-        // システムボタン状態更新
-        if (doc["system"].is<JsonObject>()) {
-            JsonObject system = doc["system"];
-            
-            if (system["plus"] | false) { webButtons.plus = true; latestInput = "+"; }
-            else { webButtons.plus = false; }
-            
-            if (system["minus"] | false) { webButtons.minus = true; latestInput = "-"; }
-            else { webButtons.minus = false; }
-            
-            if (system["home"] | false) { webButtons.home = true; latestInput = "HOME"; }
-            else { webButtons.home = false; }
+        case MACRO_WRITE_NOT_FOUND:
+            server.send_P(404, "application/json", REPLY_NOT_FOUND, sizeof(REPLY_NOT_FOUND) - 1);
+            break;
+        case MACRO_WRITE_INVALID_NAME:
+            server.send_P(400, "application/json", REPLY_BAD_NAME, sizeof(REPLY_BAD_NAME) - 1);
+            break;
+        case MACRO_WRITE_PLAYING:
+            server.send_P(409, "application/json", REPLY_MACRO_PLAYING, sizeof(REPLY_MACRO_PLAYING) - 1);
+            break;
+        default:
+            server.send_P(500, "application/json", REPLY_FS_ERROR, sizeof(REPLY_FS_ERROR) - 1);
+            break;
+    }
+}
+
+void handleMacroListGET() {
+    static MacroInfo macros[MACRO_LIST_MAX];
+    size_t count = listMacros(macros, MACRO_LIST_MAX);
+    
+    // 1件あたり最大約100byte（loopタスクのスタックを避けて静的領域）
+    static char json[MACRO_LIST_MAX * 100 + 16];
+    size_t n = snprintf(json, sizeof(json), "{\"macros\":[");
+    for (size_t i = 0; i < count && n < sizeof(json); i++) {
+        n += snprintf(json + n, sizeof(json) - n,
+                      "%s{\"name\":\"%s\",\"frames\":%lu,\"duration_ms\":%lu,\"bytes\":%lu}",
+                      i > 0 ? "," : "",
+                      macros[i].name,
+                      (unsigned long)macros[i].frames,
+                      (unsigned long)macros[i].duration_ms,
+                      (unsigned long)macros[i].bytes);
+    }
+    if (n < sizeof(json)) {
+        snprintf(json + n, sizeof(json) - n, "]}");
+    }
+    
+    server.send(200, "application/json", json);
+}
+
+void handleMacroGET() {
+    sendMacroStatus(200);
+}
+
+void handleMacroDELETE() {
+    const String &name = server.arg("name");
+    
+    // 再生中のマクロは停止してから削除
+    MacroStatus status = getMacroStatus();
+    if (status.playing && name == status.name) {
+        stopMacro();
+    }
+    
+    if (!deleteMacro(name.c_str())) {
+        server.send_P(404, "application/json", REPLY_NOT_FOUND, sizeof(REPLY_NOT_FOUND) - 1);
+        return;
+    }
+    server.send_P(200, "application/json", REPLY_OK, sizeof(REPLY_OK) - 1);
+}
+
+void handleMacroStartPOST() {
+    // ?repeat=0 で停止するまで繰り返し（省略時は1回）。負・数字以外・MACRO_REPEAT_MAXより大きい値は400
+    long repeat = 1;
+    if (server.hasArg("repeat")) {
+        const String &arg = server.arg("repeat");
+        char *end = nullptr;
+        repeat = strtol(arg.c_str(), &end, 10);
+        if (arg.length() == 0 || *end != '\0' || repeat < 0 || repeat > MACRO_REPEAT_MAX) {
+            server.send_P(400, "application/json", REPLY_BAD_REPEAT, sizeof(REPLY_BAD_REPEAT) - 1);
+            return;
         }
-        
-        // 最新入力を記録（アクティブな入力がある場合のみ）
-        if (latestInput != "") {
-            webButtons.last_active_input = latestInput;
-            webButtons.last_update_time = currentTime;
+    }
+    if (!startMacro(server.arg("name").c_str(), (uint32_t)repeat)) {
+        server.send_P(404, "application/json", REPLY_NOT_FOUND, sizeof(REPLY_NOT_FOUND) - 1);
+        return;
+    }
+    sendMacroStatus(200);
+}
+
+void handleMacroStopPOST() {
+    stopMacro();
+    sendMacroStatus(200);
+}
+
+void handleStickGET() {
+    // 現在のプロファイルと選択可能なプロファイル名
+    char json[256];
+    int length = snprintf(json, sizeof(json), "{\"left\":\"%s\",\"right\":\"%s\",\"profiles\":[",
+                          STICK_PROFILES[getStickProfile(STICK_LEFT)].name,
+                          STICK_PROFILES[getStickProfile(STICK_RIGHT)].name);
+    for (size_t i = 0; i < STICK_PROFILE_COUNT && length < (int)sizeof(json); i++) {
+        length += snprintf(json + length, sizeof(json) - length, "%s\"%s\"",
+                           i == 0 ? "" : ",", STICK_PROFILES[i].name);
+    }
+    if (length < (int)sizeof(json)) {
+        snprintf(json + length, sizeof(json) - length, "]}");
+    }
+    
+    server.send(200, "application/json", json);
+}
+
+void handleStickPOST() {
+    // ?stick=left|right（省略時は両方）、?profile=
+    const String &stick = server.arg("stick");
+    int profile = findStickProfile(server.arg("profile").c_str());
+    bool left = stick.length() == 0 || stick == "left";
+    bool right = stick.length() == 0 || stick == "right";
+    if (profile < 0 || (!left && !right)) {
+        server.send_P(400, "application/json", REPLY_BAD_STICK, sizeof(REPLY_BAD_STICK) - 1);
+        return;
+    }
+    
+    // 前回の切り替えをレポート送信タスクが反映するまで（通常1周期）は受け付けない
+    if ((left && isStickProfilePending(STICK_LEFT)) || (right && isStickProfilePending(STICK_RIGHT))) {
+        server.send_P(409, "application/json", REPLY_STICK_PENDING, sizeof(REPLY_STICK_PENDING) - 1);
+        return;
+    }
+    
+    if (left) setStickProfile(STICK_LEFT, profile);
+    if (right) setStickProfile(STICK_RIGHT, profile);
+    handleStickGET();
+}
+
+void handleTurboGET() {
+    char json[TURBO_BUTTON_COUNT * 96 + 32];
+    size_t length = formatTurboStatus(json, sizeof(json));
+    server.send(200, "application/json", length > 0 ? json : "{}");
+}
+
+void handleTurboPOST() {
+    // ?button=、?hz=（回/秒）、?duty=（押下の割合%、省略時50）
+    uint16_t bit = findTurboButton(server.arg("button").c_str());
+    if (bit == 0) {
+        server.send_P(400, "application/json", REPLY_BAD_BUTTON, sizeof(REPLY_BAD_BUTTON) - 1);
+        return;
+    }
+    
+    long duty = server.hasArg("duty") ? server.arg("duty").toInt() : 50;
+    if (duty < 1 || duty > 99 || !startTurbo(bit, server.arg("hz").toFloat(), (uint8_t)duty)) {
+        server.send_P(400, "application/json", REPLY_BAD_TURBO, sizeof(REPLY_BAD_TURBO) - 1);
+        return;
+    }
+    handleTurboGET();
+}
+
+void handleTurboDELETE() {
+    // ?button=（省略時は全ボタン）
+    uint16_t bit = 0;
+    if (server.hasArg("button")) {
+        bit = findTurboButton(server.arg("button").c_str());
+        if (bit == 0) {
+            server.send_P(400, "application/json", REPLY_BAD_BUTTON, sizeof(REPLY_BAD_BUTTON) - 1);
+            return;
         }
-        
-        server.send(200, "application/json", "{\"status\":\"OK\"}");
-    } else {
-        server.send(400, "application/json", "{\"error\":\"No JSON body\"}");
     }
+    
+    stopTurbo(bit);
+    handleTurboGET();
 }
 
 void updateWebInput() {
-    // Web入力をボタン状態に反映
-    btnA.web_input = webButtons.A;
-    btnB.web_input = webButtons.B;
-    btnX.web_input = webButtons.X;
-    btnY.web_input = webButtons.Y;
-    btnPlus.web_input = webButtons.plus;
-    btnMinus.web_input = webButtons.minus;
-    btnHome.web_input = webButtons.home;
-    
-    // 左スティックの計算
-    lstickUp.web_input = (webButtons.lstick_y < -LSTICK_THRESHOLD);
-    lstickDown.web_input = (webButtons.lstick_y > LSTICK_THRESHOLD);
-    lstickLeft.web_input = (webButtons.lstick_x < -LSTICK_THRESHOLD);
-    lstickRight.web_input = (webButtons.lstick_x > LSTICK_THRESHOLD);
-} 
\ No newline at end of file
+    ControllerState state;
+    if (!webInput.read(state)) return;
+    
+    // Web入力をボタン状態に反映（表示用、左スティック方向はLSTICK_THRESHOLDで判定）
+    for (size_t i = 0; i < TOUCH_BUTTON_COUNT; i++) {
+        touchButtons[i].web_input = isButtonActive(state, BUTTON_TABLE[i], LSTICK_THRESHOLD);
+    }
+    
+    recordInputApplied();
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include "wifi_manager.h"
+#include "input_ingest.h"
 
 /**
  * Webサーバー初期化
@@ -14,6 +15,10 @@ void initWebServer();
  */
 void handleWebServer();
 
+// ルートページ（WebServer/非同期HTTP共通）
+extern const char ROOT_PAGE_HTML[];
+extern const size_t ROOT_PAGE_HTML_LENGTH;
+
 /**
  * ルートページ処理
  */
@@ -24,6 +29,91 @@ void handleRoot();
  */
 void handleControllerPOST();
 
+/**
+ * レポート送信周期統計GET処理
+ */
+void handleStatsGET();
+
+/**
+ * 区間別レイテンシ・ヒープ等のメトリクスGET処理（Prometheus形式）
+ */
+void handleMetricsGET();
+
+/**
+ * ヒープ推移（長時間稼働試験の記録）取得処理（CSV）
+ */
+void handleSoakGET();
+
+/**
+ * タイムライン登録POST処理
+ */
+void handleTimelinePOST();
+
+/**
+ * タイムライン再生状態GET処理
+ */
+void handleTimelineGET();
+
+/**
+ * タイムライン中断DELETE処理
+ */
+void handleTimelineDELETE();
+
+/**
+ * マクロ保存POST処理（?name=、?append=1で追記）
+ */
+void handleMacroUploadPOST();
+
+/**
+ * 保存済みマクロ一覧GET処理
+ */
+void handleMacroListGET();
+
+/**
+ * マクロ再生状態GET処理
+ */
+void handleMacroGET();
+
+/**
+ * マクロ削除DELETE処理（?name=）
+ */
+void handleMacroDELETE();
+
+/**
+ * マクロ再生開始POST処理（?name=、?repeat=）
+ */
+void handleMacroStartPOST();
+
+/**
+ * マクロ再生停止POST処理
+ */
+void handleMacroStopPOST();
+
+/**
+ * スティックのプロファイルGET処理
+ */
+void handleStickGET();
+
+/**
+ * スティックのプロファイル変更POST処理（?stick=left|right、?profile=）
+ */
+void handleStickPOST();
+
+/**
+ * 連打の設定GET処理
+ */
+void handleTurboGET();
+
+/**
+ * 連打開始POST処理（?button=、?hz=、?duty=）
+ */
+void handleTurboPOST();
+
+/**
+ * 連打停止DELETE処理（?button=、省略時は全ボタン）
+ */
+void handleTurboDELETE();
+
 /**
  * Web入力の更新
  */
@@ -6,23 +6,71 @@ const char* password = WIFI_PASSWORD;
 
 // WiFi状態管理（実体）
 bool wifi_connected = false;
-String wifi_ip = "";
+char wifi_ip[16] = "";
 
-void initWiFi() {
-    WiFi.begin(ssid, password);
-    
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < WIFI_CONNECT_TIMEOUT) {
-        delay(500);
-        attempts++;
+// WiFiイベント（イベントタスクで設定し、loop()で処理）
+static std::atomic<bool> gotIpEvent{false};
+static std::atomic<bool> disconnectedEvent{false};
+static std::atomic<uint8_t> disconnectReason{0};
+
+// 接続状態（loop()からのみ更新）
+static WiFiLinkStats linkStats;
+static portMUX_TYPE wifiMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t attemptStart = 0;     // 接続試行開始時刻
+static uint32_t retryAt = 0;          // 再試行時刻
+static uint32_t nextBackoff = WIFI_BACKOFF_MIN_MS;
+
+static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            gotIpEvent.store(true);
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            disconnectReason.store(info.wifi_sta_disconnected.reason);
+            disconnectedEvent.store(true);
+            break;
+        default:
+            break;
     }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        wifi_connected = true;
-        wifi_ip = WiFi.localIP().toString();
+}
+
+static void setState(WiFiLinkState state) {
+    portENTER_CRITICAL(&wifiMux);
+    linkStats.state = state;
+    portEXIT_CRITICAL(&wifiMux);
+}
+
+// 接続試行開始（WiFi.begin()/reconnect()は結果を待たずに戻る）
+static void startAttempt(uint32_t now) {
+    if (linkStats.attempts == 0) {
+        WiFi.begin(ssid, password);
     } else {
-        wifi_connected = false;
+        WiFi.reconnect();
     }
+    attemptStart = now;
+    portENTER_CRITICAL(&wifiMux);
+    linkStats.attempts++;
+    linkStats.state = WIFI_STATE_CONNECTING;
+    portEXIT_CRITICAL(&wifiMux);
+}
+
+// 再試行待ちへ（待ち時間は失敗ごとに倍、WIFI_BACKOFF_MAX_MSまで）
+static void startBackoff(uint32_t now) {
+    retryAt = now + nextBackoff;
+    portENTER_CRITICAL(&wifiMux);
+    linkStats.backoff_ms = nextBackoff;
+    linkStats.state = WIFI_STATE_BACKOFF;
+    portEXIT_CRITICAL(&wifiMux);
+    nextBackoff = min<uint32_t>(nextBackoff * 2, WIFI_BACKOFF_MAX_MS);
+}
+
+void initWiFi() {
+    // 再接続はreconnectWiFi()で行う（ドライバーの自動再接続と競合させない）
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+    WiFi.onEvent(onWiFiEvent);
+    
+    startAttempt(millis());
 }
 
 bool isWiFiConnected() {
@@ -30,21 +78,66 @@ bool isWiFiConnected() {
 }
 
 void reconnectWiFi() {
-    if (!isWiFiConnected() && wifi_connected) {
-        wifi_connected = false;
-        
-        // 再接続試行
-        WiFi.reconnect();
-        
-        int attempts = 0;
-        while (WiFi.status() != WL_CONNECTED && attempts < WIFI_RECONNECT_TIMEOUT) {
-            delay(500);
-            attempts++;
-        }
+    if (linkStats.state == WIFI_STATE_IDLE) return;
+    
+    uint32_t now = millis();
+    
+    // 切断（接続済みからの切断、または接続失敗）
+    if (disconnectedEvent.exchange(false)) {
+        portENTER_CRITICAL(&wifiMux);
+        linkStats.last_reason = disconnectReason.load();
+        if (linkStats.state == WIFI_STATE_CONNECTED) linkStats.disconnects++;
+        portEXIT_CRITICAL(&wifiMux);
         
-        if (WiFi.status() == WL_CONNECTED) {
-            wifi_connected = true;
-            wifi_ip = WiFi.localIP().toString();
+        wifi_connected = false;
+        if (linkStats.state != WIFI_STATE_BACKOFF) {
+            startBackoff(now);
         }
     }
-} 
\ No newline at end of file
+    
+    // IP取得（処理前に切断されていれば無視）
+    if (gotIpEvent.exchange(false) && isWiFiConnected()) {
+        wifi_connected = true;
+        IPAddress ip = WiFi.localIP();
+        snprintf(wifi_ip, sizeof(wifi_ip), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        nextBackoff = WIFI_BACKOFF_MIN_MS;
+        portENTER_CRITICAL(&wifiMux);
+        linkStats.connects++;
+        linkStats.backoff_ms = 0;
+        linkStats.state = WIFI_STATE_CONNECTED;
+        portEXIT_CRITICAL(&wifiMux);
+        return;
+    }
+    
+    switch (linkStats.state) {
+        case WIFI_STATE_CONNECTING:
+            // 一定時間内にIPを取得できなければ失敗扱い
+            if (now - attemptStart >= WIFI_ATTEMPT_TIMEOUT_MS) {
+                startBackoff(now);
+            }
+            break;
+        case WIFI_STATE_BACKOFF:
+            if ((int32_t)(now - retryAt) >= 0) {
+                startAttempt(now);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+WiFiLinkStats getWiFiLinkStats() {
+    portENTER_CRITICAL(&wifiMux);
+    WiFiLinkStats copy = linkStats;
+    portEXIT_CRITICAL(&wifiMux);
+    return copy;
+}
+
+const char *wifiStateName(WiFiLinkState state) {
+    switch (state) {
+        case WIFI_STATE_CONNECTING: return "connecting";
+        case WIFI_STATE_CONNECTED: return "connected";
+        case WIFI_STATE_BACKOFF: return "backoff";
+        default: return "idle";
+    }
+}
@@ -6,10 +6,28 @@
 
 // WiFi状態管理
 extern bool wifi_connected;
-extern String wifi_ip;
+extern char wifi_ip[16];   // IPアドレス（"xxx.xxx.xxx.xxx"）
+
+// WiFi接続状態
+enum WiFiLinkState : uint8_t {
+    WIFI_STATE_IDLE = 0,     // 未開始
+    WIFI_STATE_CONNECTING,   // 接続試行中（IP取得待ち）
+    WIFI_STATE_CONNECTED,    // 接続済み（IP取得済み）
+    WIFI_STATE_BACKOFF,      // 切断・接続失敗後、再試行待ち
+};
+
+// WiFi接続統計
+struct WiFiLinkStats {
+    WiFiLinkState state = WIFI_STATE_IDLE;
+    uint32_t attempts = 0;         // 接続試行回数
+    uint32_t connects = 0;         // 接続（IP取得）回数
+    uint32_t disconnects = 0;      // 接続済みからの切断回数
+    uint32_t backoff_ms = 0;       // 現在の再試行待ち時間
+    uint8_t last_reason = 0;       // 最後の切断理由（wifi_err_reason_t）
+};
 
 /**
- * WiFi接続機能
+ * WiFi接続開始（接続完了を待たずに戻る）
  */
 void initWiFi();
 
@@ -19,8 +37,18 @@ void initWiFi();
 bool isWiFiConnected();
 
 /**
- * WiFi再接続試行
+ * WiFi接続状態の更新・再接続（loop()から毎回呼ぶ、ブロックしない）
  */
 void reconnectWiFi();
 
-#endif // WIFI_MANAGER_H 
\ No newline at end of file
+/**
+ * WiFi接続状態・統計を取得
+ */
+WiFiLinkStats getWiFiLinkStats();
+
+/**
+ * WiFi接続状態の表示名
+ */
+const char *wifiStateName(WiFiLinkState state);
+
+#endif // WIFI_MANAGER_H 
@@ -0,0 +1,98 @@
+#include "ws_input.h"
+#include "wifi_manager.h"
+#include "web_server.h"
+#include "udp_input.h"
+#include "controller_input.h"
+#include "hal.h"
+#include "env.h"
+#include <WebSocketsServer.h>
+
+// WebSocketサーバー（実体）
+static WebSocketsServer webSocket(WS_INPUT_PORT);
+static bool ws_started = false;
+static WsInputStats wsStats;
+
+// クライアントごとのバイナリフレーム受信状態
+static FrameReceiver wsReceivers[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+// 反映した状態と反映する（時刻指定なら予定の）フレーム番号をクライアントへ返す
+static void sendStateEcho(uint8_t num, uint32_t seq, const ControllerState &state, uint32_t frame) {
+    char json[192];
+    int length = snprintf(json, sizeof(json),
+                          "{\"frame\":%lu,\"seq\":%lu,\"buttons\":%u,\"hat\":%u,"
+                          "\"lstick\":{\"x\":%d,\"y\":%d},\"rstick\":{\"x\":%d,\"y\":%d}}",
+                          (unsigned long)frame, (unsigned long)seq,
+                          state.buttons, state.hat,
+                          state.lstick_x, state.lstick_y, state.rstick_x, state.rstick_y);
+    webSocket.sendTXT(num, json, length);
+}
+
+// JSONフレーム（/controllerと同じ形式 + 任意の"seq"）
+static void handleTextFrame(uint8_t num, uint8_t *payload, size_t length) {
+    ControllerState state;
+    uint32_t seq = 0;
+    ReportCycle cycle;
+    if (ingestControllerJson((const char *)payload, length, state, &seq, &cycle) != JSON_INGEST_OK) {
+        wsStats.rejected++;
+        return;
+    }
+
+    wsStats.text_frames++;
+    sendStateEcho(num, seq, state, cycle.frame);
+}
+
+// バイナリフレーム（UDPと同じ形式）
+static void handleBinaryFrame(uint8_t num, uint8_t *payload, size_t length) {
+    FrameReceiver &receiver = wsReceivers[num];
+    lockWebInput();
+    bool applied = applyInputFrame(receiver, payload, length, millis());
+    unlockWebInput();
+    if (!applied) {
+        wsStats.rejected++;
+        return;
+    }
+
+    wsStats.binary_frames++;
+    ControllerState state;
+    webInput.read(state);
+    sendStateEcho(num, receiver.stats.last_seq, state, predictReportCycle(halMicros()).frame);
+}
+
+static void onWebSocketEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+
+    switch (type) {
+        case WStype_CONNECTED:
+            wsReceivers[num] = FrameReceiver();
+            wsStats.clients++;
+            break;
+        case WStype_DISCONNECTED:
+            if (wsStats.clients > 0) wsStats.clients--;
+            break;
+        case WStype_TEXT:
+            handleTextFrame(num, payload, length);
+            break;
+        case WStype_BIN:
+            handleBinaryFrame(num, payload, length);
+            break;
+        default:
+            break;
+    }
+}
+
+void initWebSocketInput() {
+    // WiFi接続前でも待ち受けを開始（接続・再接続後にそのまま受信）
+    webSocket.begin();
+    webSocket.onEvent(onWebSocketEvent);
+    ws_started = true;
+}
+
+void handleWebSocketInput() {
+    if (ws_started && wifi_connected) {
+        webSocket.loop();
+    }
+}
+
+WsInputStats getWebSocketInputStats() {
+    return wsStats;
+}
@@ -0,0 +1,29 @@
+#ifndef WS_INPUT_H
+#define WS_INPUT_H
+
+#include "types.h"
+
+// WebSocket入力統計
+struct WsInputStats {
+    uint32_t clients = 0;        // 接続中クライアント数
+    uint32_t text_frames = 0;    // 受信JSONフレーム数
+    uint32_t binary_frames = 0;  // 受信バイナリフレーム数
+    uint32_t rejected = 0;       // 破棄したフレーム数（形式不正/古いシーケンス）
+};
+
+/**
+ * WebSocketサーバー初期化
+ */
+void initWebSocketInput();
+
+/**
+ * WebSocket処理（受信フレームの反映）
+ */
+void handleWebSocketInput();
+
+/**
+ * WebSocket入力統計を取得
+ */
+WsInputStats getWebSocketInputStats();
+
+#endif // WS_INPUT_H
@@ -0,0 +1,68 @@
+// HTTPリクエスト解析のテスト（ホスト実行用）
+//
+// ビルド・実行: cd test && make run
+
+#include <cstdio>
+#include <cstring>
+#include "http_request.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+} while (0)
+
+// 受信バッファの大きさ（native版と同じ）
+static const size_t CAPACITY = 8192;
+
+static HttpParseResult parse(const char *text, HttpRequest &request) {
+    return parseHttpRequest(text, strlen(text), CAPACITY, request);
+}
+
+static HttpParseResult parseWithLength(const char *contentLength) {
+    char text[256];
+    snprintf(text, sizeof(text), "POST /controller HTTP/1.1\r\nContent-Length: %s\r\n\r\n{}", contentLength);
+    HttpRequest request;
+    return parse(text, request);
+}
+
+static void testBody() {
+    HttpRequest request;
+    const char *text = "POST /controller HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}GET / HTTP/1.1\r\n\r\n";
+    CHECK(parse(text, request) == HTTP_PARSE_OK);
+    CHECK(request.body_length == 2);
+    CHECK(memcmp(request.body, "{}", 2) == 0);
+    CHECK(request.total == strlen(text) - strlen("GET / HTTP/1.1\r\n\r\n"));
+    CHECK(request.keep_alive);
+}
+
+static void testIncomplete() {
+    HttpRequest request;
+    CHECK(parse("POST /controller HTTP/1.1\r\nContent-Length: 10\r\n\r\n{}", request) == HTTP_PARSE_INCOMPLETE);
+    CHECK(parse("POST /controller HTTP/1.1\r\nContent-", request) == HTTP_PARSE_INCOMPLETE);
+}
+
+static void testContentLength() {
+    // 符号・数字以外・空は不正
+    CHECK(parseWithLength("-1") == HTTP_PARSE_INVALID);
+    CHECK(parseWithLength("+2") == HTTP_PARSE_INVALID);
+    CHECK(parseWithLength("abc") == HTTP_PARSE_INVALID);
+    CHECK(parseWithLength("2abc") == HTTP_PARSE_INVALID);
+    CHECK(parseWithLength("0x10") == HTTP_PARSE_INVALID);
+    CHECK(parseWithLength("") == HTTP_PARSE_INVALID);
+    // size_tを超える値は不正、収まるが受信バッファより大きい値は大きすぎる
+    CHECK(parseWithLength("18446744073709551616") == HTTP_PARSE_INVALID);
+    CHECK(parseWithLength("99999999999999999999999") == HTTP_PARSE_INVALID);
+    CHECK(parseWithLength("18446744073709551615") == HTTP_PARSE_TOO_LARGE);
+    CHECK(parseWithLength("8193") == HTTP_PARSE_TOO_LARGE);
+    CHECK(parseWithLength("2") == HTTP_PARSE_OK);
+    CHECK(parseWithLength(" 2 ") == HTTP_PARSE_OK);
+}
+
+int main() {
+    testBody();
+    testIncomplete();
+    testContentLength();
+    printf("http_request_test: %s\n", failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+// レポート周期（入力の合成・押下エッジ）のテスト（ホスト実行用）
+//
+// ビルド・実行: cd test && make run
+
+#include <cstdio>
+#include "report_cycle.h"
+#include "controller_state.h"
+#include "input_edges.h"
+#include "stick_curve.h"
+#include "hal.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } \
+} while (0)
+
+// テスト用HAL: 時刻は手動で進め、送信したレポートを記録する
+static int64_t nowUs = 1000000;
+static SwitchReport sent;
+
+uint32_t halMillis() { return (uint32_t)(nowUs / 1000); }
+int64_t halMicros() { return nowUs; }
+void halSendReport(const SwitchReport &report) { sent = report; }
+
+// 1周期進めてレポートを作成
+static void cycle(bool timelineActive) {
+    nowUs += 8000;
+    runReportCycle(timelineActive);
+}
+
+// 周期の間に押して離す
+static void tap(ControllerStateChannel &channel, uint16_t button) {
+    ControllerState state;
+    state.buttons = button;
+    channel.publish(state);
+    channel.publish(ControllerState());
+}
+
+// 押下の保持が終わるまで周期を進める
+static void settle(bool timelineActive) {
+    for (int i = 0; i < 8; i++) cycle(timelineActive);
+}
+
+static void testWebTap() {
+    tap(webInput, SWITCH_BTN_A);
+    cycle(false);
+    CHECK(sent.buttons & SWITCH_BTN_A);
+    settle(false);
+    CHECK(sent.buttons == 0);
+}
+
+static void testWebTapDuringTimeline() {
+    uint32_t ignored = getInputEdgeStats().ignored;
+    settle(true);
+
+    // タイムライン再生中のWebのタップはレポートに出ない
+    tap(webInput, SWITCH_BTN_A);
+    cycle(true);
+    CHECK(!(sent.buttons & SWITCH_BTN_A));
+    CHECK(getInputEdgeStats().ignored == ignored + 1);
+
+    // タイムラインのタップは出る
+    tap(timelineInput, SWITCH_BTN_B);
+    cycle(true);
+    CHECK(sent.buttons == SWITCH_BTN_B);
+
+    // 再生中のWebのタップは再生終了後にも持ち越さない
+    tap(webInput, SWITCH_BTN_X);
+    cycle(true);
+    cycle(false);
+    CHECK(sent.buttons == 0);
+    settle(false);
+    CHECK(sent.buttons == 0);
+}
+
+int main() {
+    initStickCurves();
+    testWebTap();
+    testWebTapDuringTimeline();
+    printf("report_cycle_test: %s\n", failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}